@@ -5059,10 +5059,10 @@ static void test_GetFileAttributesExW(void)
 static void test_post_completion(void)
 {
     OVERLAPPED ovl, ovl2, *povl;
-    OVERLAPPED_ENTRY entries[2];
+    OVERLAPPED_ENTRY entries[2], many_entries[150];
     ULONG_PTR key;
     HANDLE port;
-    ULONG count;
+    ULONG count, i;
     DWORD size;
     BOOL ret;
 
@@ -5161,6 +5161,28 @@ static void test_post_completion(void)
 
     SleepEx(0, TRUE);
 
+    for (i = 0; i < 100; i++)
+    {
+        ret = PostQueuedCompletionStatus( port, i, 456, &ovl );
+        ok(ret, "PostQueuedCompletionStatus failed: %u\n", GetLastError());
+    }
+
+    count = 0xdeadbeef;
+    memset( many_entries, 0xcc, sizeof(many_entries) );
+    ret = pGetQueuedCompletionStatusEx( port, many_entries, ARRAY_SIZE(many_entries), &count, 0, FALSE );
+    ok(ret, "GetQueuedCompletionStatusEx failed\n");
+    ok(count == 100, "wrong count %u\n", count);
+    for (i = 0; i < min( count, 100 ); i++)
+    {
+        ok(many_entries[i].lpCompletionKey == 456, "%u: wrong key %lu\n", i, many_entries[i].lpCompletionKey);
+        ok(many_entries[i].dwNumberOfBytesTransferred == i, "%u: wrong size %u\n",
+           i, many_entries[i].dwNumberOfBytesTransferred);
+    }
+
+    ret = GetQueuedCompletionStatus( port, &size, &key, &povl, 0 );
+    ok(!ret, "GetQueuedCompletionStatus succeeded\n");
+    ok(GetLastError() == WAIT_TIMEOUT, "wrong error %u\n", GetLastError());
+
     CloseHandle( port );
 }
 
@@ -39,6 +39,7 @@
 #define HEAP_VALIDATE_PARAMS  0x40000000
 
 static BOOL (WINAPI *pHeapQueryInformation)(HANDLE, HEAP_INFORMATION_CLASS, PVOID, SIZE_T, PSIZE_T);
+static BOOL (WINAPI *pHeapSetInformation)(HANDLE, HEAP_INFORMATION_CLASS, PVOID, SIZE_T);
 static BOOL (WINAPI *pGetPhysicallyInstalledSystemMemory)(ULONGLONG *);
 static ULONG (WINAPI *pRtlGetNtGlobalFlags)(void);
 
@@ -892,6 +893,64 @@ static void test_HeapQueryInformation(void)
     ok(info == 0 || info == 1 || info == 2, "expected 0, 1 or 2, got %u\n", info);
 }
 
+static void test_HeapSetInformation(void)
+{
+    ULONG info;
+    HANDLE heap;
+    BYTE *p, *p2;
+    SIZE_T i;
+    BOOL ret;
+
+    pHeapSetInformation = (void *)GetProcAddress(GetModuleHandleA("kernel32.dll"), "HeapSetInformation");
+    if (!pHeapSetInformation || !pHeapQueryInformation)
+    {
+        win_skip("HeapSetInformation is not available\n");
+        return;
+    }
+
+    heap = HeapCreate(0, 0, 0);
+    ok(heap != NULL, "HeapCreate error %u\n", GetLastError());
+
+    info = 2;
+    ret = pHeapSetInformation(heap, HeapCompatibilityInformation, &info, sizeof(info));
+    ok(ret, "HeapSetInformation error %u\n", GetLastError());
+
+    info = 0xdeadbeef;
+    ret = pHeapQueryInformation(heap, HeapCompatibilityInformation, &info, sizeof(info), NULL);
+    ok(ret, "HeapQueryInformation error %u\n", GetLastError());
+    ok(info == 2, "expected 2, got %u\n", info);
+
+    for (i = 1; i < 1024; i += 7)
+    {
+        p = HeapAlloc(heap, 0, i);
+        ok(p != NULL, "HeapAlloc failed for size %lu\n", i);
+        memset(p, 0xcc, i);
+        ok(HeapSize(heap, 0, p) == i, "wrong size %lu/%lu\n", HeapSize(heap, 0, p), i);
+        ret = HeapFree(heap, 0, p);
+        ok(ret, "HeapFree failed for size %lu\n", i);
+
+        p2 = HeapAlloc(heap, HEAP_ZERO_MEMORY, i);
+        ok(p2 != NULL, "HeapAlloc failed for size %lu\n", i);
+        ok(HeapSize(heap, 0, p2) == i, "wrong size %lu/%lu\n", HeapSize(heap, 0, p2), i);
+        ok(!p2[0] && !p2[i - 1], "block of size %lu not zeroed\n", i);
+        ret = HeapFree(heap, 0, p2);
+        ok(ret, "HeapFree failed for size %lu\n", i);
+    }
+    HeapDestroy(heap);
+
+    heap = HeapCreate(HEAP_NO_SERIALIZE, 0, 0);
+    ok(heap != NULL, "HeapCreate error %u\n", GetLastError());
+    info = 2;
+    ret = pHeapSetInformation(heap, HeapCompatibilityInformation, &info, sizeof(info));
+    ok(!ret, "HeapSetInformation should fail on a HEAP_NO_SERIALIZE heap\n");
+
+    info = 0xdeadbeef;
+    ret = pHeapQueryInformation(heap, HeapCompatibilityInformation, &info, sizeof(info), NULL);
+    ok(ret, "HeapQueryInformation error %u\n", GetLastError());
+    ok(info == 0, "expected 0, got %u\n", info);
+    HeapDestroy(heap);
+}
+
 static void test_heap_checks( DWORD flags )
 {
     BYTE old, *p, *p2;
@@ -1245,6 +1304,7 @@ START_TEST(heap)
     test_sized_HeapReAlloc((1 << 20), 1);
 
     test_HeapQueryInformation();
+    test_HeapSetInformation();
     test_GetPhysicallyInstalledSystemMemory();
 
     if (pRtlGetNtGlobalFlags)
@@ -304,6 +304,39 @@ static void testGetProcAddress_Wrong(void)
     ok( GetLastError() == ERROR_MOD_NOT_FOUND, "Expected ERROR_MOD_NOT_FOUND, got %d\n", GetLastError() );
 }
 
+static void testGetProcAddress_Names(void)
+{
+    const IMAGE_EXPORT_DIRECTORY *exports;
+    const IMAGE_NT_HEADERS *nt;
+    const DWORD *names;
+    const WORD *ordinals;
+    HMODULE module;
+    FARPROC fp, fp2;
+    DWORD i;
+
+    module = GetModuleHandleA("kernel32.dll");
+    nt = (const IMAGE_NT_HEADERS *)((const char *)module + ((const IMAGE_DOS_HEADER *)module)->e_lfanew);
+    exports = (const IMAGE_EXPORT_DIRECTORY *)((const char *)module +
+              nt->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT].VirtualAddress);
+    names = (const DWORD *)((const char *)module + exports->AddressOfNames);
+    ordinals = (const WORD *)((const char *)module + exports->AddressOfNameOrdinals);
+    ok( exports->NumberOfNames > 100, "got %u names\n", exports->NumberOfNames );
+
+    /* look up every name, twice, so that large export tables are looked up repeatedly */
+    for (i = 0; i < 2 * exports->NumberOfNames; i++)
+    {
+        const char *name = (const char *)module + names[i % exports->NumberOfNames];
+        fp = GetProcAddress( module, name );
+        fp2 = GetProcAddress( module, (LPCSTR)(ULONG_PTR)(ordinals[i % exports->NumberOfNames] + exports->Base) );
+        ok( fp == fp2, "%s: got %p, expected %p\n", name, fp, fp2 );
+    }
+
+    SetLastError(0xdeadbeef);
+    fp = GetProcAddress( module, "CreateFileA_non_ex" );
+    ok( !fp, "CreateFileA_non_ex should not be found\n" );
+    ok( GetLastError() == ERROR_PROC_NOT_FOUND, "Expected ERROR_PROC_NOT_FOUND, got %d\n", GetLastError() );
+}
+
 static void testLoadLibraryEx(void)
 {
     CHAR path[MAX_PATH];
@@ -1110,6 +1143,7 @@ START_TEST(module)
     testNestedLoadLibraryA();
     testLoadLibraryA_Wrong();
     testGetProcAddress_Wrong();
+    testGetProcAddress_Names();
     testLoadLibraryEx();
     test_LoadLibraryEx_search_flags();
     testGetModuleHandleEx();
@@ -25,6 +25,8 @@
 #include <errno.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <sys/types.h>
 #ifdef HAVE_SYS_SYSCALL_H
 #include <sys/syscall.h>
@@ -39,6 +41,7 @@
 
 WINE_DEFAULT_DEBUG_CHANNEL(ntdll);
 WINE_DECLARE_DEBUG_CHANNEL(relay);
+WINE_DECLARE_DEBUG_CHANNEL(critstats);
 
 static inline LONG interlocked_inc( PLONG dest )
 {
@@ -240,6 +243,170 @@ static inline NTSTATUS wait_semaphore( RTL_CRITICAL_SECTION *crit, int timeout )
     return ret;
 }
 
+/* adaptive spinning: the debug info of the sections we allocate is followed
+ * by the time their owners hold them, and the spin budget is reduced for
+ * sections that are held longer than spinning is worth, down to CRIT_MIN_SPIN.
+ * Times are in performance counter units (100ns). */
+#define CRIT_MIN_SPIN       64
+#define CRIT_MAX_SPIN_HOLD  200  /* hold time above which spinning gets shorter */
+#define CRIT_DEBUG_EX_MAGIC 0x4843  /* stored in CreatorBackTraceIndex */
+
+struct crit_debug_ex
+{
+    RTL_CRITICAL_SECTION_DEBUG debug;      /* must be the first field */
+    LONGLONG                   acquire_time; /* time the owner acquired the section */
+    LONGLONG                   hold_time;  /* running average of the time it is held */
+};
+
+static inline struct crit_debug_ex *get_crit_debug_ex( RTL_CRITICAL_SECTION *crit )
+{
+    if (!crit->SpinCount || !crit->DebugInfo) return NULL;
+    if (crit->DebugInfo->CreatorBackTraceIndex != CRIT_DEBUG_EX_MAGIC) return NULL;
+    return (struct crit_debug_ex *)crit->DebugInfo;
+}
+
+/***********************************************************************
+ *           get_spin_limit
+ *
+ * The budget is the configured SpinCount, scaled down for long hold times.
+ */
+static inline ULONG get_spin_limit( RTL_CRITICAL_SECTION *crit )
+{
+    struct crit_debug_ex *info = get_crit_debug_ex( crit );
+    ULONGLONG limit;
+
+    if (!info || info->hold_time <= CRIT_MAX_SPIN_HOLD) return crit->SpinCount;
+    limit = (ULONGLONG)crit->SpinCount * CRIT_MAX_SPIN_HOLD / info->hold_time;
+    return min( max( limit, CRIT_MIN_SPIN ), crit->SpinCount );
+}
+
+/***********************************************************************
+ *           record_crit_acquire
+ */
+static inline void record_crit_acquire( RTL_CRITICAL_SECTION *crit )
+{
+    struct crit_debug_ex *info = get_crit_debug_ex( crit );
+    LARGE_INTEGER now;
+
+    if (!info) return;
+    NtQueryPerformanceCounter( &now, NULL );
+    info->acquire_time = now.QuadPart;
+}
+
+/***********************************************************************
+ *           record_crit_release
+ *
+ * Only the owner updates the hold time, no locked instructions are needed.
+ */
+static inline void record_crit_release( RTL_CRITICAL_SECTION *crit )
+{
+    struct crit_debug_ex *info = get_crit_debug_ex( crit );
+    LARGE_INTEGER now;
+
+    if (!info || !info->acquire_time) return;
+    NtQueryPerformanceCounter( &now, NULL );
+    info->hold_time += (now.QuadPart - info->acquire_time - info->hold_time) / 8;
+}
+
+
+/* contention profiler, enabled with WINEDEBUG=+critstats */
+#define CRIT_STATS_SIZE 1024  /* must be a power of 2 */
+#define CRIT_STATS_DUMP 32
+
+struct crit_stats
+{
+    RTL_CRITICAL_SECTION *crit;
+    char                  name[64];  /* copied, the owning module may be unloaded */
+    LONG                  waits;
+    LONGLONG              wait_time;
+    LONGLONG              max_wait;
+};
+
+static struct crit_stats crit_stats_table[CRIT_STATS_SIZE];
+static LONG crit_stats_dropped;
+
+/***********************************************************************
+ *           get_crit_stats
+ *
+ * Find or create the profiler entry of a critical section.
+ */
+static struct crit_stats *get_crit_stats( RTL_CRITICAL_SECTION *crit )
+{
+    unsigned int i, pos = ((ULONG_PTR)crit >> 4) & (CRIT_STATS_SIZE - 1);
+
+    for (i = 0; i < CRIT_STATS_SIZE; i++, pos = (pos + 1) & (CRIT_STATS_SIZE - 1))
+    {
+        struct crit_stats *stats = &crit_stats_table[pos];
+        RTL_CRITICAL_SECTION *prev;
+
+        if (stats->crit == crit) return stats;
+        if (stats->crit) continue;
+        prev = interlocked_cmpxchg_ptr( (void **)&stats->crit, crit, NULL );
+        if (prev && prev != crit) continue;
+        return stats;
+    }
+    interlocked_inc( &crit_stats_dropped );
+    return NULL;
+}
+
+/***********************************************************************
+ *           record_crit_wait
+ */
+static void record_crit_wait( RTL_CRITICAL_SECTION *crit, LONGLONG elapsed )
+{
+    struct crit_stats *stats = get_crit_stats( crit );
+    LONGLONG prev;
+
+    if (!stats) return;
+    if (!stats->name[0] && crit->DebugInfo && crit->DebugInfo->Spare[0])
+    {
+        const char *name = (const char *)crit->DebugInfo->Spare[0];
+        memcpy( stats->name, name, min( strlen(name), sizeof(stats->name) - 1 ));
+    }
+    interlocked_inc( &stats->waits );
+    do prev = stats->wait_time;
+    while (interlocked_cmpxchg64( &stats->wait_time, prev + elapsed, prev ) != prev);
+    do prev = stats->max_wait;
+    while (elapsed > prev && interlocked_cmpxchg64( &stats->max_wait, elapsed, prev ) != prev);
+}
+
+static int crit_stats_compare( const void *a, const void *b )
+{
+    const struct crit_stats *sa = a, *sb = b;
+
+    if (sa->wait_time != sb->wait_time) return sa->wait_time < sb->wait_time ? 1 : -1;
+    return sb->waits - sa->waits;
+}
+
+/***********************************************************************
+ *           crit_dump_all_stats
+ *
+ * Print the critical sections with the highest total wait time.
+ */
+void crit_dump_all_stats(void)
+{
+    struct crit_stats *sorted;
+    LARGE_INTEGER counter, freq;
+    unsigned int i, count = 0;
+
+    if (!TRACE_ON(critstats)) return;
+
+    if (!(sorted = RtlAllocateHeap( GetProcessHeap(), 0, sizeof(crit_stats_table) ))) return;
+    for (i = 0; i < CRIT_STATS_SIZE; i++)
+        if (crit_stats_table[i].waits) sorted[count++] = crit_stats_table[i];
+    qsort( sorted, count, sizeof(*sorted), crit_stats_compare );
+
+    NtQueryPerformanceCounter( &counter, &freq );
+    TRACE_(critstats)( "%u contended sections, %d not recorded\n", count, crit_stats_dropped );
+    for (i = 0; i < count && i < CRIT_STATS_DUMP; i++)
+        TRACE_(critstats)( "section %p %s: %d waits, total %s us, max %s us\n",
+                           sorted[i].crit, debugstr_a(sorted[i].name[0] ? sorted[i].name : "?"),
+                           sorted[i].waits,
+                           wine_dbgstr_longlong( sorted[i].wait_time * 1000000 / freq.QuadPart ),
+                           wine_dbgstr_longlong( sorted[i].max_wait * 1000000 / freq.QuadPart ));
+    RtlFreeHeap( GetProcessHeap(), 0, sorted );
+}
+
 /***********************************************************************
  *           RtlInitializeCriticalSection   (NTDLL.@)
  *
@@ -323,12 +490,16 @@ NTSTATUS WINAPI RtlInitializeCriticalSectionEx( RTL_CRITICAL_SECTION *crit, ULON
     if (flags & RTL_CRITICAL_SECTION_FLAG_NO_DEBUG_INFO)
         crit->DebugInfo = NULL;
     else
-        crit->DebugInfo = RtlAllocateHeap(GetProcessHeap(), 0, sizeof(RTL_CRITICAL_SECTION_DEBUG));
+    {
+        /* the hold time of the owners follows the debug info, see get_spin_limit */
+        struct crit_debug_ex *info = RtlAllocateHeap( GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(*info) );
+        crit->DebugInfo = info ? &info->debug : NULL;
+    }
 
     if (crit->DebugInfo)
     {
         crit->DebugInfo->Type = 0;
-        crit->DebugInfo->CreatorBackTraceIndex = 0;
+        crit->DebugInfo->CreatorBackTraceIndex = CRIT_DEBUG_EX_MAGIC;
         crit->DebugInfo->CriticalSection = crit;
         crit->DebugInfo->ProcessLocksList.Blink = &(crit->DebugInfo->ProcessLocksList);
         crit->DebugInfo->ProcessLocksList.Flink = &(crit->DebugInfo->ProcessLocksList);
@@ -436,6 +607,9 @@ NTSTATUS WINAPI RtlDeleteCriticalSection( RTL_CRITICAL_SECTION *crit )
 NTSTATUS WINAPI RtlpWaitForCriticalSection( RTL_CRITICAL_SECTION *crit )
 {
     LONGLONG timeout = NtCurrentTeb()->Peb->CriticalSectionTimeout.QuadPart / -10000000;
+    LARGE_INTEGER start, end;
+
+    if (TRACE_ON(critstats)) NtQueryPerformanceCounter( &start, NULL );
 
     /* Don't allow blocking on a critical section during process termination */
     if (RtlDllShutdownInProgress())
@@ -486,6 +660,11 @@ NTSTATUS WINAPI RtlpWaitForCriticalSection( RTL_CRITICAL_SECTION *crit )
         RtlRaiseException( &rec );
     }
     if (crit->DebugInfo) crit->DebugInfo->ContentionCount++;
+    if (TRACE_ON(critstats))
+    {
+        NtQueryPerformanceCounter( &end, NULL );
+        record_crit_wait( crit, end.QuadPart - start.QuadPart );
+    }
     return STATUS_SUCCESS;
 }
 
@@ -549,10 +728,11 @@ NTSTATUS WINAPI RtlEnterCriticalSection( RTL_CRITICAL_SECTION *crit )
 {
     if (crit->SpinCount)
     {
-        ULONG count;
+        ULONG count, limit;
 
         if (RtlTryEnterCriticalSection( crit )) return STATUS_SUCCESS;
-        for (count = crit->SpinCount; count > 0; count--)
+        limit = get_spin_limit( crit );
+        for (count = 0; count < limit; count++)
         {
             if (crit->LockCount > 0) break;  /* more than one waiter, don't bother spinning */
             if (crit->LockCount == -1)       /* try again */
@@ -577,6 +757,7 @@ NTSTATUS WINAPI RtlEnterCriticalSection( RTL_CRITICAL_SECTION *crit )
 done:
     crit->OwningThread   = ULongToHandle(GetCurrentThreadId());
     crit->RecursionCount = 1;
+    record_crit_acquire( crit );
     return STATUS_SUCCESS;
 }
 
@@ -606,6 +787,7 @@ BOOL WINAPI RtlTryEnterCriticalSection( RTL_CRITICAL_SECTION *crit )
     {
         crit->OwningThread   = ULongToHandle(GetCurrentThreadId());
         crit->RecursionCount = 1;
+        record_crit_acquire( crit );
         ret = TRUE;
     }
     else if (crit->OwningThread == ULongToHandle(GetCurrentThreadId()))
@@ -681,6 +863,7 @@ NTSTATUS WINAPI RtlLeaveCriticalSection( RTL_CRITICAL_SECTION *crit )
     }
     else
     {
+        record_crit_release( crit );
         crit->OwningThread = 0;
         if (interlocked_dec( &crit->LockCount ) >= 0)
         {
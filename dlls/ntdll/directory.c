@@ -216,6 +216,28 @@ static RTL_CRITICAL_SECTION_DEBUG critsect_debug =
 };
 static RTL_CRITICAL_SECTION dir_section = { &critsect_debug, -1, 0, 0, 0, 0 };
 
+/* cache of directory contents for case-insensitive lookups */
+#define DIR_LOOKUP_CACHE_SIZE 16
+
+struct dir_lookup_cache
+{
+    struct dir_data *data;       /* directory names, sorted by lower-cased long name */
+    time_t           mtime;      /* directory modification time when it was read */
+    unsigned int     last_use;   /* counter value of the last use, for eviction */
+};
+
+static struct dir_lookup_cache dir_lookup_cache[DIR_LOOKUP_CACHE_SIZE];
+static unsigned int dir_lookup_counter;
+
+static RTL_CRITICAL_SECTION dir_lookup_section;
+static RTL_CRITICAL_SECTION_DEBUG dir_lookup_critsect_debug =
+{
+    0, 0, &dir_lookup_section,
+    { &dir_lookup_critsect_debug.ProcessLocksList, &dir_lookup_critsect_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": dir_lookup_section") }
+};
+static RTL_CRITICAL_SECTION dir_lookup_section = { &dir_lookup_critsect_debug, -1, 0, 0, 0, 0 };
+
 
 /* check if a given Unicode char is OK in a DOS short name */
 static inline BOOL is_invalid_dos_char( WCHAR ch )
@@ -1807,18 +1829,68 @@ static NTSTATUS read_directory_data( struct dir_data *data, int fd, const UNICOD
 }
 
 
+struct dir_sort_key
+{
+    const WCHAR           *key;      /* upper-cased long name */
+    struct dir_data_names  names;    /* directory entry names */
+};
+
 /* compare file names for directory sorting */
 static int name_compare( const void *a, const void *b )
 {
-    const struct dir_data_names *file_a = (const struct dir_data_names *)a;
-    const struct dir_data_names *file_b = (const struct dir_data_names *)b;
-    int ret = RtlCompareUnicodeStrings( file_a->long_name, strlenW(file_a->long_name),
-                                        file_b->long_name, strlenW(file_b->long_name), TRUE );
-    if (!ret) ret = strcmpW( file_a->long_name, file_b->long_name );
+    const struct dir_sort_key *file_a = (const struct dir_sort_key *)a;
+    const struct dir_sort_key *file_b = (const struct dir_sort_key *)b;
+    /* same ordering as a case-insensitive RtlCompareUnicodeStrings */
+    int ret = strcmpW( file_a->key, file_b->key );
+    if (!ret) ret = strcmpW( file_a->names.long_name, file_b->names.long_name );
     return ret;
 }
 
 
+/***********************************************************************
+ *           sort_dir_data_names
+ *
+ * Sort the directory names starting at index start. The upper-cased sort
+ * keys are computed once up front instead of on every comparison, which
+ * matters for large directories.
+ */
+static BOOL sort_dir_data_names( struct dir_data *data, unsigned int start )
+{
+    unsigned int i, j, count = data->count > start ? data->count - start : 0, total = 0;
+    struct dir_sort_key *keys;
+    WCHAR *buffer, *p;
+
+    if (count < 2) return TRUE;
+
+    for (i = start; i < data->count; i++) total += strlenW( data->names[i].long_name ) + 1;
+
+    keys = RtlAllocateHeap( GetProcessHeap(), 0, count * sizeof(*keys) );
+    buffer = RtlAllocateHeap( GetProcessHeap(), 0, total * sizeof(WCHAR) );
+    if (!keys || !buffer)
+    {
+        RtlFreeHeap( GetProcessHeap(), 0, keys );
+        RtlFreeHeap( GetProcessHeap(), 0, buffer );
+        return FALSE;
+    }
+
+    for (i = 0, p = buffer; i < count; i++)
+    {
+        const WCHAR *name = data->names[start + i].long_name;
+        keys[i].key   = p;
+        keys[i].names = data->names[start + i];
+        for (j = 0; name[j]; j++) *p++ = toupperW( name[j] );
+        *p++ = 0;
+    }
+
+    qsort( keys, count, sizeof(*keys), name_compare );
+    for (i = 0; i < count; i++) data->names[start + i] = keys[i].names;
+
+    RtlFreeHeap( GetProcessHeap(), 0, keys );
+    RtlFreeHeap( GetProcessHeap(), 0, buffer );
+    return TRUE;
+}
+
+
 /***********************************************************************
  *           init_cached_dir_data
  *
@@ -1844,7 +1916,11 @@ static NTSTATUS init_cached_dir_data( struct dir_data **data_ret, int fd, const
     i = 0;
     if (i < data->count && !strcmp( data->names[i].unix_name, "." )) i++;
     if (i < data->count && !strcmp( data->names[i].unix_name, ".." )) i++;
-    if (i < data->count) qsort( data->names + i, data->count - i, sizeof(*data->names), name_compare );
+    if (!sort_dir_data_names( data, i ))
+    {
+        free_dir_data( data );
+        return STATUS_NO_MEMORY;
+    }
 
     if (data->count)
     {
@@ -2024,6 +2100,167 @@ NTSTATUS WINAPI NtQueryDirectoryFile( HANDLE handle, HANDLE event,
 }
 
 
+/* compare lower-cased long names for sorting the lookup cache */
+static int lookup_name_compare( const void *a, const void *b )
+{
+    const struct dir_data_names *file_a = a;
+    const struct dir_data_names *file_b = b;
+    return strcmpW( file_a->long_name, file_b->long_name );
+}
+
+
+/***********************************************************************
+ *           read_dir_lookup_data
+ *
+ * Read all the names of a directory, lower-cased and sorted for binary search.
+ */
+static struct dir_data *read_dir_lookup_data( const char *unix_name )
+{
+    static const WCHAR empty[1];
+    WCHAR buffer[MAX_DIR_ENTRY_LEN + 1];
+    struct dir_data *data;
+    struct dirent *de;
+    DIR *dir;
+    int i, len;
+
+    if (!(dir = opendir( unix_name ))) return NULL;
+    if (!(data = RtlAllocateHeap( GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(*data) )))
+    {
+        closedir( dir );
+        return NULL;
+    }
+
+    while ((de = readdir( dir )))
+    {
+        len = ntdll_umbstowcs( 0, de->d_name, strlen(de->d_name), buffer, MAX_DIR_ENTRY_LEN );
+        if (len <= 0) continue;
+        for (i = 0; i < len; i++) buffer[i] = tolowerW( buffer[i] );
+        buffer[len] = 0;
+        if (!add_dir_data_names( data, buffer, empty, de->d_name ))
+        {
+            closedir( dir );
+            free_dir_data( data );
+            return NULL;
+        }
+    }
+    closedir( dir );
+
+    if (data->count) qsort( data->names, data->count, sizeof(*data->names), lookup_name_compare );
+    return data;
+}
+
+
+/***********************************************************************
+ *           find_lookup_name
+ *
+ * Binary search for a lower-cased name in the lookup data. The name is appended
+ * to unix_name at pos. Returns STATUS_NO_SUCH_FILE if the name is ambiguous.
+ */
+static NTSTATUS find_lookup_name( const struct dir_data *data, const WCHAR *name,
+                                  char *unix_name, int pos )
+{
+    int min = 0, max = data->count - 1, res, pos_found;
+
+    while (min <= max)
+    {
+        pos_found = (min + max) / 2;
+        if (!(res = strcmpW( data->names[pos_found].long_name, name )))
+        {
+            /* several files only differing by case, let the caller decide using readdir order */
+            if ((pos_found > 0 && !strcmpW( data->names[pos_found - 1].long_name, name )) ||
+                (pos_found < data->count - 1 && !strcmpW( data->names[pos_found + 1].long_name, name )))
+                return STATUS_NO_SUCH_FILE;
+
+            unix_name[pos - 1] = '/';
+            strcpy( unix_name + pos, data->names[pos_found].unix_name );
+            return STATUS_SUCCESS;
+        }
+        if (res > 0) max = pos_found - 1;
+        else min = pos_found + 1;
+    }
+    return STATUS_OBJECT_PATH_NOT_FOUND;
+}
+
+
+/***********************************************************************
+ *           find_file_in_dir_cache
+ *
+ * Look up a long file name case-insensitively in the cached contents of the
+ * directory unix_name, which get read on first use and invalidated when the
+ * modification time of the directory changes. The file found is appended to
+ * unix_name at pos. Returns STATUS_NO_SUCH_FILE if the cache cannot be used
+ * and the directory has to be scanned.
+ */
+static NTSTATUS find_file_in_dir_cache( char *unix_name, int pos, const WCHAR *name, int length )
+{
+    WCHAR lower[MAX_DIR_ENTRY_LEN + 1];
+    struct dir_lookup_cache *entry = NULL;
+    struct dir_data *data;
+    struct stat st;
+    NTSTATUS status;
+    time_t now;
+    int i;
+
+    if (length > MAX_DIR_ENTRY_LEN) return STATUS_NO_SUCH_FILE;
+    if (stat( unix_name, &st ) == -1) return STATUS_NO_SUCH_FILE;
+
+    for (i = 0; i < length; i++) lower[i] = tolowerW( name[i] );
+    lower[length] = 0;
+
+    RtlEnterCriticalSection( &dir_lookup_section );
+    for (i = 0; i < DIR_LOOKUP_CACHE_SIZE; i++)
+    {
+        if (!dir_lookup_cache[i].data) continue;
+        if (dir_lookup_cache[i].data->id.dev != st.st_dev ||
+            dir_lookup_cache[i].data->id.ino != st.st_ino) continue;
+        if (dir_lookup_cache[i].mtime == st.st_mtime)
+        {
+            dir_lookup_cache[i].last_use = ++dir_lookup_counter;
+            status = find_lookup_name( dir_lookup_cache[i].data, lower, unix_name, pos );
+            RtlLeaveCriticalSection( &dir_lookup_section );
+            return status;
+        }
+        TRACE( "directory %s changed, discarding cached names\n", debugstr_a(unix_name) );
+        free_dir_data( dir_lookup_cache[i].data );
+        dir_lookup_cache[i].data = NULL;
+    }
+    RtlLeaveCriticalSection( &dir_lookup_section );
+
+    now = time( NULL );
+    if (!(data = read_dir_lookup_data( unix_name ))) return STATUS_NO_SUCH_FILE;
+    data->id.dev = st.st_dev;
+    data->id.ino = st.st_ino;
+    status = find_lookup_name( data, lower, unix_name, pos );
+
+    /* changes within the same second don't update the modification time,
+     * so a directory modified that recently can't be cached reliably */
+    if (st.st_mtime >= now)
+    {
+        free_dir_data( data );
+        return status;
+    }
+
+    RtlEnterCriticalSection( &dir_lookup_section );
+    for (i = 0; i < DIR_LOOKUP_CACHE_SIZE; i++)
+    {
+        if (!dir_lookup_cache[i].data ||
+            (dir_lookup_cache[i].data->id.dev == st.st_dev &&
+             dir_lookup_cache[i].data->id.ino == st.st_ino))
+        {
+            entry = &dir_lookup_cache[i];
+            break;
+        }
+        if (!entry || dir_lookup_cache[i].last_use < entry->last_use) entry = &dir_lookup_cache[i];
+    }
+    free_dir_data( entry->data );
+    entry->data     = data;
+    entry->mtime    = st.st_mtime;
+    entry->last_use = ++dir_lookup_counter;
+    RtlLeaveCriticalSection( &dir_lookup_section );
+    return status;
+}
+
+
 /***********************************************************************
  *           find_file_in_dir
  *
@@ -2134,6 +2371,16 @@ static NTSTATUS find_file_in_dir( char *unix_name, int pos, const WCHAR *name, i
     }
 #endif /* VFAT_IOCTL_READDIR_BOTH */
 
+    /* short names are not cached, they still need a full directory scan */
+    switch (find_file_in_dir_cache( unix_name, pos, name, length ))
+    {
+    case STATUS_SUCCESS:
+        goto success;
+    case STATUS_OBJECT_PATH_NOT_FOUND:
+        if (!is_name_8_dot_3) goto not_found;
+        break;
+    }
+
     if (!(dir = opendir( unix_name )))
     {
         if (errno == ENOENT) return STATUS_OBJECT_PATH_NOT_FOUND;
@@ -45,6 +45,7 @@
 #include "wine/server.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(heap);
+WINE_DECLARE_DEBUG_CHANNEL(heapstats);
 
 /* Note: the heap data structures are loosely based on what Pietrek describes in his
  * book 'Windows 95 System Programming Secrets', with some adaptations for
@@ -83,6 +84,7 @@ typedef struct
 /* Value for arena 'magic' field */
 #define ARENA_INUSE_MAGIC      0x455355
 #define ARENA_PENDING_MAGIC    0xbedead
+#define ARENA_CACHED_MAGIC     0x484643
 #define ARENA_FREE_MAGIC       0x45455246
 #define ARENA_LARGE_MAGIC      0x6752614c
 
@@ -126,6 +128,12 @@ static const SIZE_T HEAP_freeListSizes[] =
 };
 #define HEAP_NB_FREE_LISTS (ARRAY_SIZE( HEAP_freeListSizes ) + HEAP_NB_SMALL_FREE_LISTS)
 
+/* The low fragmentation front end keeps a lookaside bin for every arena size up to this value */
+#define HEAP_MAX_LFH_BLOCK_SIZE 0x200
+#define HEAP_NB_LFH_BINS (((HEAP_MAX_LFH_BLOCK_SIZE - HEAP_MIN_DATA_SIZE) / ALIGNMENT) + 1)
+/* max number of cached blocks in each lookaside bin */
+#define HEAP_MAX_LFH_DEPTH 64
+
 typedef union
 {
     ARENA_FREE  arena;
@@ -164,6 +172,13 @@ typedef struct tagHEAP
     ARENA_INUSE    **pending_free;  /* Ring buffer for pending free requests */
     RTL_CRITICAL_SECTION critSection; /* Critical section for serialization */
     FREE_LIST_ENTRY *freeList;      /* Free lists */
+    SIZE_T           large_count;   /* Number of blocks in the large blocks list */
+    SIZE_T           large_size;    /* Total virtual size of the large blocks */
+    SIZE_T           alloc_count;   /* Number of allocations served by the back end */
+    SIZE_T           free_count;    /* Number of frees handled by the back end */
+    BOOL             lfh_enabled;   /* Low fragmentation front end enabled */
+    LONG             lfh_walkers;   /* Threads walking the sub-heap list without the lock */
+    SLIST_HEADER     lfh_bins[HEAP_NB_LFH_BINS]; /* Lookaside bins of the front end */
 } HEAP;
 
 #define HEAP_MAGIC       ((DWORD)('H' | ('E'<<8) | ('A'<<16) | ('P'<<24)))
@@ -296,7 +311,8 @@ static void subheap_notify_free_all(SUBHEAP const *subheap)
         {
             ARENA_INUSE const *pArena = (ARENA_INUSE const *)ptr;
             if (pArena->magic == ARENA_INUSE_MAGIC) notify_free(pArena + 1);
-            else if (pArena->magic != ARENA_PENDING_MAGIC) ERR("bad inuse_magic @%p\n", pArena);
+            else if (pArena->magic != ARENA_PENDING_MAGIC && pArena->magic != ARENA_CACHED_MAGIC)
+                ERR("bad inuse_magic @%p\n", pArena);
             ptr += sizeof(*pArena) + (pArena->size & ARENA_SIZE_MASK);
         }
     }
@@ -442,6 +458,181 @@ static void HEAP_DumpEntry( LPPROCESS_HEAP_ENTRY entry )
     }
 }
 
+/***********************************************************************
+ *           heap_get_stats
+ *
+ * Compute the summary statistics of a heap; the heap lock must be held.
+ * The in-use size includes the arena headers and the blocks cached by the front end.
+ */
+static void heap_get_stats( HEAP *heap, HEAP_WINE_STATISTICS *stats, SIZE_T *list_counts )
+{
+    SIZE_T total = 0;
+    SUBHEAP *subheap;
+    ARENA_FREE *arena;
+    unsigned int i = 0;
+
+    memset( stats, 0, sizeof(*stats) );
+    LIST_FOR_EACH_ENTRY( subheap, &heap->subheap_list, SUBHEAP, entry )
+    {
+        stats->ReservedSize += subheap->size;
+        stats->CommittedSize += subheap->commitSize;
+        total += subheap->size - subheap->headerSize;
+    }
+
+    /* the free lists are chained one after the other, separated by their list heads */
+    LIST_FOR_EACH_ENTRY( arena, &heap->freeList[0].arena.entry, ARENA_FREE, entry )
+    {
+        if (i + 1 < HEAP_NB_FREE_LISTS && arena == &heap->freeList[i + 1].arena)
+        {
+            i++;
+            continue;
+        }
+        if (list_counts) list_counts[i]++;
+        stats->FreeBlocks++;
+        stats->FreeSize += (arena->size & ARENA_SIZE_MASK) + sizeof(ARENA_FREE);
+    }
+
+    if (heap->lfh_enabled)
+        for (i = 0; i < HEAP_NB_LFH_BINS; i++) stats->CachedBlocks += RtlQueryDepthSList( &heap->lfh_bins[i] );
+
+    stats->InUseSize   = total - stats->FreeSize;
+    stats->LargeBlocks = heap->large_count;
+    stats->LargeSize   = heap->large_size;
+    stats->AllocCount  = heap->alloc_count;
+    stats->FreeCount   = heap->free_count;
+}
+
+
+/***********************************************************************
+ *           heap_dump_stats
+ *
+ * Print summary statistics for a heap; the heap lock must be held.
+ */
+static void heap_dump_stats( HEAP *heap )
+{
+    HEAP_WINE_STATISTICS stats;
+    SIZE_T list_counts[HEAP_NB_FREE_LISTS] = { 0 };
+    unsigned int i;
+
+    heap_get_stats( heap, &stats, list_counts );
+    TRACE_(heapstats)( "heap %p: reserved %#lx committed %#lx in use %#lx free %#lx in %lu blocks, "
+                       "%lu cached blocks, %lu large blocks of total size %#lx, %lu allocs %lu frees\n",
+                       heap, stats.ReservedSize, stats.CommittedSize, stats.InUseSize, stats.FreeSize,
+                       stats.FreeBlocks, stats.CachedBlocks, stats.LargeBlocks, stats.LargeSize,
+                       stats.AllocCount, stats.FreeCount );
+    for (i = 0; i < HEAP_NB_FREE_LISTS; i++)
+    {
+        if (!list_counts[i]) continue;
+        TRACE_(heapstats)( "heap %p: free list %u (size <= %#lx): %lu blocks\n", heap, i,
+                           i < HEAP_NB_SMALL_FREE_LISTS ? HEAP_MIN_ARENA_SIZE + i * ALIGNMENT :
+                           HEAP_freeListSizes[i - HEAP_NB_SMALL_FREE_LISTS], list_counts[i] );
+    }
+}
+
+
+/* allocation site profiler, enabled with WINEDEBUG=+heapstats */
+#define HEAP_SAMPLE_RATE  256   /* one allocation out of this many is sampled */
+#define HEAP_SAMPLES_SIZE 1024  /* must be a power of 2 */
+#define HEAP_SAMPLES_DUMP 32
+
+struct heap_sample
+{
+    void     *caller;
+    LONG      count;
+    LONGLONG  bytes;
+};
+
+static struct heap_sample heap_samples[HEAP_SAMPLES_SIZE];
+static LONG heap_sample_tick;
+static LONG heap_samples_dropped;
+
+/***********************************************************************
+ *           heap_sample_alloc
+ *
+ * Record the caller of a sampled allocation.
+ */
+static void heap_sample_alloc( void *caller, SIZE_T size )
+{
+    unsigned int i, pos;
+    LONGLONG prev;
+
+    pos = ((ULONG_PTR)caller >> 2) & (HEAP_SAMPLES_SIZE - 1);
+    for (i = 0; i < HEAP_SAMPLES_SIZE; i++, pos = (pos + 1) & (HEAP_SAMPLES_SIZE - 1))
+    {
+        struct heap_sample *sample = &heap_samples[pos];
+        void *old;
+
+        if (sample->caller != caller)
+        {
+            if (sample->caller) continue;
+            old = interlocked_cmpxchg_ptr( &sample->caller, caller, NULL );
+            if (old && old != caller) continue;
+        }
+        interlocked_xchg_add( &sample->count, 1 );
+        do prev = sample->bytes;
+        while (interlocked_cmpxchg64( &sample->bytes, prev + size, prev ) != prev);
+        return;
+    }
+    interlocked_xchg_add( &heap_samples_dropped, 1 );
+}
+
+static int heap_sample_compare( const void *a, const void *b )
+{
+    const struct heap_sample *sa = a, *sb = b;
+
+    if (sa->bytes != sb->bytes) return sa->bytes < sb->bytes ? 1 : -1;
+    return sb->count - sa->count;
+}
+
+/***********************************************************************
+ *           heap_dump_samples
+ *
+ * Print the sampled allocation sites that requested the most memory.
+ */
+static void heap_dump_samples(void)
+{
+    struct heap_sample *sorted;
+    unsigned int i, count = 0;
+
+    if (!(sorted = RtlAllocateHeap( processHeap, 0, sizeof(heap_samples) ))) return;
+    for (i = 0; i < HEAP_SAMPLES_SIZE; i++)
+        if (heap_samples[i].count) sorted[count++] = heap_samples[i];
+    qsort( sorted, count, sizeof(*sorted), heap_sample_compare );
+
+    TRACE_(heapstats)( "%u allocation sites sampled every %u allocations, %d not recorded\n",
+                       count, HEAP_SAMPLE_RATE, heap_samples_dropped );
+    for (i = 0; i < count && i < HEAP_SAMPLES_DUMP; i++)
+        TRACE_(heapstats)( "caller %p: %d samples, %s bytes\n", sorted[i].caller, sorted[i].count,
+                           wine_dbgstr_longlong( sorted[i].bytes ));
+    RtlFreeHeap( processHeap, 0, sorted );
+}
+
+
+/***********************************************************************
+ *           heap_dump_all_stats
+ *
+ * Print summary statistics for all the heaps of the process.
+ */
+void heap_dump_all_stats(void)
+{
+    HEAP *heap;
+
+    if (!TRACE_ON(heapstats) || !processHeap) return;
+
+    RtlEnterCriticalSection( &processHeap->critSection );
+    heap_dump_stats( processHeap );
+    LIST_FOR_EACH_ENTRY( heap, &processHeap->entry, HEAP, entry )
+    {
+        RtlEnterCriticalSection( &heap->critSection );
+        heap_dump_stats( heap );
+        RtlLeaveCriticalSection( &heap->critSection );
+    }
+    RtlLeaveCriticalSection( &processHeap->critSection );
+
+    heap_dump_samples();
+}
+
+
 /***********************************************************************
  *           HEAP_GetPtr
  * RETURNS
@@ -680,6 +871,8 @@ static void HEAP_MakeInUseBlockFree( SUBHEAP *subheap, ARENA_INUSE *pArena )
         list_remove( &pFree->entry );
         /* Remove the subheap from the list */
         list_remove( &subheap->entry );
+        /* wait for the front end to stop walking the list, it may still be on this entry */
+        while (heap->lfh_walkers) NtYieldExecution();
         /* Free the memory */
         subheap->magic = 0;
         NtFreeVirtualMemory( NtCurrentProcess(), &addr, &size, MEM_RELEASE );
@@ -739,6 +932,8 @@ static void *allocate_large_block( HEAP *heap, DWORD flags, SIZE_T size )
     arena->magic = ARENA_LARGE_MAGIC;
     mark_block_tail( (char *)(arena + 1) + size, block_size - sizeof(*arena) - size, flags );
     list_add_tail( &heap->large_list, &arena->entry );
+    heap->large_count++;
+    heap->large_size += block_size;
     notify_alloc( arena + 1, size, flags & HEAP_ZERO_MEMORY );
     return arena + 1;
 }
@@ -754,6 +949,8 @@ static void free_large_block( HEAP *heap, DWORD flags, void *ptr )
     SIZE_T size = 0;
 
     list_remove( &arena->entry );
+    heap->large_count--;
+    heap->large_size -= arena->block_size;
     NtFreeVirtualMemory( NtCurrentProcess(), &address, &size, MEM_RELEASE );
 }
 
@@ -915,7 +1112,12 @@ static SUBHEAP *HEAP_CreateSubHeap( HEAP *heap, LPVOID address, DWORD flags,
         subheap->commitSize = commitSize;
         subheap->magic      = SUBHEAP_MAGIC;
         subheap->headerSize = ROUND_SIZE( sizeof(SUBHEAP) );
-        list_add_head( &heap->subheap_list, &subheap->entry );
+        /* the front end walks the list without holding the lock, so the
+         * entry has to be complete before it is linked in */
+        subheap->entry.next = heap->subheap_list.next;
+        subheap->entry.prev = &heap->subheap_list;
+        subheap->entry.next->prev = &subheap->entry;
+        interlocked_xchg_ptr( (void **)&heap->subheap_list.next, &subheap->entry );
     }
     else
     {
@@ -925,6 +1127,12 @@ static SUBHEAP *HEAP_CreateSubHeap( HEAP *heap, LPVOID address, DWORD flags,
         heap->flags         = flags;
         heap->magic         = HEAP_MAGIC;
         heap->grow_size     = max( HEAP_DEF_SIZE, totalSize );
+        heap->lfh_enabled   = FALSE;
+        heap->lfh_walkers   = 0;
+        heap->large_count   = 0;
+        heap->large_size    = 0;
+        heap->alloc_count   = 0;
+        heap->free_count    = 0;
         list_init( &heap->subheap_list );
         list_init( &heap->large_list );
 
@@ -1214,7 +1422,8 @@ static BOOL HEAP_ValidateInUseArena( const SUBHEAP *subheap, const ARENA_INUSE *
     }
 
     /* Check magic number */
-    if (pArena->magic != ARENA_INUSE_MAGIC && pArena->magic != ARENA_PENDING_MAGIC)
+    if (pArena->magic != ARENA_INUSE_MAGIC && pArena->magic != ARENA_PENDING_MAGIC &&
+        pArena->magic != ARENA_CACHED_MAGIC)
     {
         if (quiet == NOISY) {
             ERR("Heap %p: invalid in-use arena magic %08x for %p\n", subheap->heap, pArena->magic, pArena );
@@ -1429,7 +1638,7 @@ static BOOL validate_block_pointer( HEAP *heap, SUBHEAP **ret_subheap, const ARE
         ret = HEAP_ValidateInUseArena( subheap, arena, QUIET );
     else if ((ULONG_PTR)arena % ALIGNMENT != ARENA_OFFSET)
         WARN( "Heap %p: unaligned arena pointer %p\n", subheap->heap, arena );
-    else if (arena->magic == ARENA_PENDING_MAGIC)
+    else if (arena->magic == ARENA_PENDING_MAGIC || arena->magic == ARENA_CACHED_MAGIC)
         WARN( "Heap %p: block %p used after free\n", subheap->heap, arena + 1 );
     else if (arena->magic != ARENA_INUSE_MAGIC)
         WARN( "Heap %p: invalid in-use arena magic %08x for %p\n", subheap->heap, arena->magic, arena );
@@ -1447,6 +1656,63 @@ static BOOL validate_block_pointer( HEAP *heap, SUBHEAP **ret_subheap, const ARE
 }
 
 
+/***********************************************************************
+ *           lfh_alloc_block
+ *
+ * Grab a cached block of the given arena size from the front end lookaside bins.
+ * Called without holding the heap lock.
+ */
+static ARENA_INUSE *lfh_alloc_block( HEAP *heap, SIZE_T rounded_size )
+{
+    SLIST_ENTRY *entry;
+    ARENA_INUSE *arena;
+
+    if (rounded_size > HEAP_MAX_LFH_BLOCK_SIZE) return NULL;
+    if (!(entry = RtlInterlockedPopEntrySList( &heap->lfh_bins[(rounded_size - HEAP_MIN_DATA_SIZE) / ALIGNMENT] )))
+        return NULL;
+    arena = (ARENA_INUSE *)entry - 1;
+    arena->magic = ARENA_INUSE_MAGIC;
+    return arena;
+}
+
+
+/***********************************************************************
+ *           lfh_free_block
+ *
+ * Put a small block into the front end lookaside bins instead of freeing it.
+ * Called without holding the heap lock; sub-heaps are not released while the
+ * list is walked here, and sub-heaps holding cached blocks are never empty.
+ */
+static BOOL lfh_free_block( HEAP *heap, ARENA_INUSE *arena )
+{
+    SUBHEAP *subheap;
+    SLIST_HEADER *bin;
+    SIZE_T size;
+    BOOL ret = FALSE;
+
+    interlocked_xchg_add( &heap->lfh_walkers, 1 );
+
+    if (!(subheap = HEAP_FindSubHeap( heap, arena ))) goto done;
+    if ((char *)arena < (char *)subheap->base + subheap->headerSize) goto done;
+    if ((ULONG_PTR)arena % ALIGNMENT != ARENA_OFFSET) goto done;
+    if (arena->magic != ARENA_INUSE_MAGIC) goto done;
+    if (arena->size & ARENA_FLAG_FREE) goto done;
+
+    size = arena->size & ARENA_SIZE_MASK;
+    if (size > HEAP_MAX_LFH_BLOCK_SIZE) goto done;
+    bin = &heap->lfh_bins[(size - HEAP_MIN_DATA_SIZE) / ALIGNMENT];
+    if (RtlQueryDepthSList( bin ) >= HEAP_MAX_LFH_DEPTH) goto done;
+
+    arena->magic = ARENA_CACHED_MAGIC;
+    RtlInterlockedPushEntrySList( bin, (SLIST_ENTRY *)(arena + 1) );
+    ret = TRUE;
+
+done:
+    interlocked_xchg_add( &heap->lfh_walkers, -1 );
+    return ret;
+}
+
+
 /***********************************************************************
  *           heap_set_debug_flags
  */
@@ -1612,6 +1878,13 @@ HANDLE WINAPI RtlDestroyHeap( HANDLE heap )
     list_remove( &heapPtr->entry );
     RtlLeaveCriticalSection( &processHeap->critSection );
 
+    if (TRACE_ON(heapstats))
+    {
+        RtlEnterCriticalSection( &heapPtr->critSection );
+        heap_dump_stats( heapPtr );
+        RtlLeaveCriticalSection( &heapPtr->critSection );
+    }
+
     heapPtr->critSection.DebugInfo->Spare[0] = 0;
     RtlDeleteCriticalSection( &heapPtr->critSection );
 
@@ -1683,11 +1956,28 @@ void * WINAPI DECLSPEC_HOTPATCH RtlAllocateHeap( HANDLE heap, ULONG flags, SIZE_
     }
     if (rounded_size < HEAP_MIN_DATA_SIZE) rounded_size = HEAP_MIN_DATA_SIZE;
 
+    if (TRACE_ON(heapstats) && !(interlocked_xchg_add( &heap_sample_tick, 1 ) % HEAP_SAMPLE_RATE))
+    {
+        void *caller = NULL;
+        RtlCaptureStackBackTrace( 1, 1, &caller, NULL );
+        heap_sample_alloc( caller, size );
+    }
+
+    if (heapPtr->lfh_enabled && (pInUse = lfh_alloc_block( heapPtr, rounded_size )))
+    {
+        pInUse->unused_bytes = (pInUse->size & ARENA_SIZE_MASK) - size;
+        notify_alloc( pInUse + 1, size, flags & HEAP_ZERO_MEMORY );
+        initialize_block( pInUse + 1, size, pInUse->unused_bytes, flags );
+        TRACE("(%p,%08x,%08lx): returning %p\n", heap, flags, size, pInUse + 1 );
+        return pInUse + 1;
+    }
+
     if (!(flags & HEAP_NO_SERIALIZE)) RtlEnterCriticalSection( &heapPtr->critSection );
 
     if (rounded_size >= HEAP_MIN_LARGE_BLOCK_SIZE && (flags & HEAP_GROWABLE))
     {
         void *ret = allocate_large_block( heap, flags, size );
+        if (ret) heapPtr->alloc_count++;
         if (!(flags & HEAP_NO_SERIALIZE)) RtlLeaveCriticalSection( &heapPtr->critSection );
         if (!ret && (flags & HEAP_GENERATE_EXCEPTIONS)) RtlRaiseStatus( STATUS_NO_MEMORY );
         TRACE("(%p,%08x,%08lx): returning %p\n", heap, flags, size, ret );
@@ -1725,6 +2015,7 @@ void * WINAPI DECLSPEC_HOTPATCH RtlAllocateHeap( HANDLE heap, ULONG flags, SIZE_
 
     notify_alloc( pInUse + 1, size, flags & HEAP_ZERO_MEMORY );
     initialize_block( pInUse + 1, size, pInUse->unused_bytes, flags );
+    heapPtr->alloc_count++;
 
     if (!(flags & HEAP_NO_SERIALIZE)) RtlLeaveCriticalSection( &heapPtr->critSection );
 
@@ -1766,14 +2057,22 @@ BOOLEAN WINAPI DECLSPEC_HOTPATCH RtlFreeHeap( HANDLE heap, ULONG flags, void *pt
 
     flags &= HEAP_NO_SERIALIZE;
     flags |= heapPtr->flags;
+    pInUse  = (ARENA_INUSE *)ptr - 1;
+
+    if (heapPtr->lfh_enabled && lfh_free_block( heapPtr, pInUse ))
+    {
+        TRACE("(%p,%08x,%p): returning TRUE\n", heap, flags, ptr );
+        return TRUE;
+    }
+
     if (!(flags & HEAP_NO_SERIALIZE)) RtlEnterCriticalSection( &heapPtr->critSection );
 
     /* Inform valgrind we are trying to free memory, so it can throw up an error message */
     notify_free( ptr );
 
     /* Some sanity checks */
-    pInUse  = (ARENA_INUSE *)ptr - 1;
     if (!validate_block_pointer( heapPtr, &subheap, pInUse )) goto error;
+    heapPtr->free_count++;
 
     if (!subheap)
         free_large_block( heapPtr, flags, ptr );
@@ -2133,7 +2432,8 @@ NTSTATUS WINAPI RtlWalkHeap( HANDLE heap, PVOID entry_ptr )
         }
 
         if (((ARENA_INUSE *)ptr - 1)->magic == ARENA_INUSE_MAGIC ||
-            ((ARENA_INUSE *)ptr - 1)->magic == ARENA_PENDING_MAGIC)
+            ((ARENA_INUSE *)ptr - 1)->magic == ARENA_PENDING_MAGIC ||
+            ((ARENA_INUSE *)ptr - 1)->magic == ARENA_CACHED_MAGIC)
         {
             ARENA_INUSE *pArena = (ARENA_INUSE *)ptr - 1;
             ptr += pArena->size & ARENA_SIZE_MASK;
@@ -2181,7 +2481,7 @@ NTSTATUS WINAPI RtlWalkHeap( HANDLE heap, PVOID entry_ptr )
         entry->lpData = pArena + 1;
         entry->cbData = pArena->size & ARENA_SIZE_MASK;
         entry->cbOverhead = sizeof(ARENA_INUSE);
-        entry->wFlags = (pArena->magic == ARENA_PENDING_MAGIC) ?
+        entry->wFlags = (pArena->magic == ARENA_PENDING_MAGIC || pArena->magic == ARENA_CACHED_MAGIC) ?
                         PROCESS_HEAP_UNCOMMITTED_RANGE : PROCESS_HEAP_ENTRY_BUSY;
         /* FIXME: can't handle PROCESS_HEAP_ENTRY_MOVEABLE
         and PROCESS_HEAP_ENTRY_DDESHARE yet */
@@ -2246,6 +2546,20 @@ ULONG WINAPI RtlGetProcessHeaps( ULONG count, HANDLE *heaps )
 NTSTATUS WINAPI RtlQueryHeapInformation( HANDLE heap, HEAP_INFORMATION_CLASS info_class,
                                          PVOID info, SIZE_T size_in, PSIZE_T size_out)
 {
+    HEAP *heapPtr;
+
+    if (info_class == HeapWineStatistics)
+    {
+        if (size_out) *size_out = sizeof(HEAP_WINE_STATISTICS);
+        if (size_in < sizeof(HEAP_WINE_STATISTICS)) return STATUS_BUFFER_TOO_SMALL;
+        if (!(heapPtr = HEAP_GetPtr( heap ))) return STATUS_INVALID_HANDLE;
+
+        RtlEnterCriticalSection( &heapPtr->critSection );
+        heap_get_stats( heapPtr, info, NULL );
+        RtlLeaveCriticalSection( &heapPtr->critSection );
+        return STATUS_SUCCESS;
+    }
+
     switch (info_class)
     {
     case HeapCompatibilityInformation:
@@ -2254,7 +2568,8 @@ NTSTATUS WINAPI RtlQueryHeapInformation( HANDLE heap, HEAP_INFORMATION_CLASS inf
         if (size_in < sizeof(ULONG))
             return STATUS_BUFFER_TOO_SMALL;
 
-        *(ULONG *)info = 0; /* standard heap */
+        heapPtr = HEAP_GetPtr( heap );
+        *(ULONG *)info = (heapPtr && heapPtr->lfh_enabled) ? 2 : 0; /* low fragmentation or standard heap */
         return STATUS_SUCCESS;
 
     default:
@@ -2268,6 +2583,43 @@ NTSTATUS WINAPI RtlQueryHeapInformation( HANDLE heap, HEAP_INFORMATION_CLASS inf
  */
 NTSTATUS WINAPI RtlSetHeapInformation( HANDLE heap, HEAP_INFORMATION_CLASS info_class, PVOID info, SIZE_T size)
 {
-    FIXME("%p %d %p %ld stub\n", heap, info_class, info, size);
-    return STATUS_SUCCESS;
+    HEAP *heapPtr;
+    unsigned int i;
+
+    switch (info_class)
+    {
+    case HeapCompatibilityInformation:
+        if (size < sizeof(ULONG)) return STATUS_BUFFER_TOO_SMALL;
+        if (!(heapPtr = HEAP_GetPtr( heap ))) return STATUS_INVALID_HANDLE;
+
+        switch (*(ULONG *)info)
+        {
+        case 0:
+            if (heapPtr->lfh_enabled) FIXME( "%p: cannot disable the low fragmentation front end\n", heap );
+            return STATUS_SUCCESS;
+        case 2:
+            /* the lookaside bins bypass the heap lock and the debug checks */
+            if ((heapPtr->flags & (HEAP_NO_SERIALIZE | HEAP_SHARED | HEAP_TAIL_CHECKING_ENABLED |
+                                   HEAP_FREE_CHECKING_ENABLED | HEAP_VALIDATE)) ||
+                heapPtr->pending_free || RUNNING_ON_VALGRIND)
+                return STATUS_UNSUCCESSFUL;
+
+            RtlEnterCriticalSection( &heapPtr->critSection );
+            if (!heapPtr->lfh_enabled)
+            {
+                for (i = 0; i < HEAP_NB_LFH_BINS; i++) RtlInitializeSListHead( &heapPtr->lfh_bins[i] );
+                heapPtr->lfh_enabled = TRUE;
+            }
+            RtlLeaveCriticalSection( &heapPtr->critSection );
+            TRACE( "enabled low fragmentation front end for heap %p\n", heap );
+            return STATUS_SUCCESS;
+        default:
+            FIXME( "%p: unsupported compatibility mode %u\n", heap, *(ULONG *)info );
+            return STATUS_SUCCESS;
+        }
+
+    default:
+        FIXME("%p %d %p %ld stub\n", heap, info_class, info, size);
+        return STATUS_SUCCESS;
+    }
 }
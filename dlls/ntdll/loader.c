@@ -50,6 +50,7 @@ WINE_DECLARE_DEBUG_CHANNEL(relay);
 WINE_DECLARE_DEBUG_CHANNEL(snoop);
 WINE_DECLARE_DEBUG_CHANNEL(loaddll);
 WINE_DECLARE_DEBUG_CHANNEL(imports);
+WINE_DECLARE_DEBUG_CHANNEL(loadtime);
 
 #ifdef _WIN64
 #define DEFAULT_SECURITY_COOKIE_64  (((ULONGLONG)0x00002b99 << 32) | 0x2ddfa232)
@@ -102,8 +103,15 @@ typedef struct _wine_modref
     int                   alloc_deps;
     int                   nDeps;
     struct _wine_modref **deps;
+    DWORD                *export_hash;       /* hash table of export name indices + 1 */
+    DWORD                 export_hash_mask;  /* size of the hash table - 1 */
+    DWORD                 export_lookups;    /* number of name lookups before the hash was built */
 } WINE_MODREF;
 
+/* export name lookups are done with a hash table for large export tables that are used often */
+#define EXPORT_HASH_MIN_NAMES   64
+#define EXPORT_HASH_MIN_LOOKUPS 16
+
 /* info about the current builtin dll load */
 /* used to keep track of things across the register_dll constructor call */
 struct builtin_load_info
@@ -141,6 +149,22 @@ static FARPROC find_ordinal_export( HMODULE module, const IMAGE_EXPORT_DIRECTORY
 static FARPROC find_named_export( HMODULE module, const IMAGE_EXPORT_DIRECTORY *exports,
                                   DWORD exp_size, const char *name, int hint, LPCWSTR load_path );
 
+/* time spent in the loader phases, only collected when the loadtime channel is enabled */
+static ULONGLONG loadtime_resolve;
+static ULONGLONG loadtime_relocs;
+static ULONGLONG loadtime_init;
+static int loadtime_depth;
+
+/* get the current time in microseconds for the loadtime channel */
+static ULONGLONG loadtime_now(void)
+{
+    LARGE_INTEGER counter, freq;
+
+    NtQueryPerformanceCounter( &counter, &freq );
+    return counter.QuadPart / freq.QuadPart * 1000000 +
+           counter.QuadPart % freq.QuadPart * 1000000 / freq.QuadPart;
+}
+
 /* convert PE image VirtualAddress to Real Address */
 static inline void *get_rva( HMODULE module, DWORD va )
 {
@@ -609,6 +633,41 @@ static FARPROC find_ordinal_export( HMODULE module, const IMAGE_EXPORT_DIRECTORY
 }
 
 
+static inline DWORD hash_export_name( const char *name )
+{
+    DWORD hash = 0;
+    while (*name) hash = hash * 31 + (unsigned char)*name++;
+    return hash;
+}
+
+
+/*************************************************************************
+ *		build_export_hash
+ *
+ * Build the hash table of the export names of a module.
+ * The loader_section must be locked while calling this function.
+ */
+static void build_export_hash( WINE_MODREF *wm, const IMAGE_EXPORT_DIRECTORY *exports )
+{
+    const DWORD *names = get_rva( wm->ldr.BaseAddress, exports->AddressOfNames );
+    DWORD i, pos, size = 1;
+
+    while (size < exports->NumberOfNames * 2) size <<= 1;
+    if (!(wm->export_hash = RtlAllocateHeap( GetProcessHeap(), HEAP_ZERO_MEMORY, size * sizeof(DWORD) )))
+        return;
+    wm->export_hash_mask = size - 1;
+
+    for (i = 0; i < exports->NumberOfNames; i++)
+    {
+        pos = hash_export_name( get_rva( wm->ldr.BaseAddress, names[i] )) & wm->export_hash_mask;
+        while (wm->export_hash[pos]) pos = (pos + 1) & wm->export_hash_mask;
+        wm->export_hash[pos] = i + 1;
+    }
+    TRACE( "built export hash for %s, %u names\n",
+           debugstr_w(wm->ldr.BaseDllName.Buffer), exports->NumberOfNames );
+}
+
+
 /*************************************************************************
  *		find_named_export
  *
@@ -621,6 +680,7 @@ static FARPROC find_named_export( HMODULE module, const IMAGE_EXPORT_DIRECTORY *
     const WORD *ordinals = get_rva( module, exports->AddressOfNameOrdinals );
     const DWORD *names = get_rva( module, exports->AddressOfNames );
     int min = 0, max = exports->NumberOfNames - 1;
+    WINE_MODREF *wm;
 
     /* first check the hint */
     if (hint >= 0 && hint <= max)
@@ -630,6 +690,26 @@ static FARPROC find_named_export( HMODULE module, const IMAGE_EXPORT_DIRECTORY *
             return find_ordinal_export( module, exports, exp_size, ordinals[hint], load_path );
     }
 
+    /* then use the hash table if the module is looked up often enough */
+    if (exports->NumberOfNames >= EXPORT_HASH_MIN_NAMES && (wm = get_modref( module )))
+    {
+        if (!wm->export_hash && ++wm->export_lookups >= EXPORT_HASH_MIN_LOOKUPS)
+            build_export_hash( wm, exports );
+
+        if (wm->export_hash)
+        {
+            DWORD idx, pos = hash_export_name( name ) & wm->export_hash_mask;
+
+            while ((idx = wm->export_hash[pos]))
+            {
+                if (!strcmp( get_rva( module, names[idx - 1] ), name ))
+                    return find_ordinal_export( module, exports, exp_size, ordinals[idx - 1], load_path );
+                pos = (pos + 1) & wm->export_hash_mask;
+            }
+            return NULL;
+        }
+    }
+
     /* then do a binary search */
     while (min <= max)
     {
@@ -666,6 +746,7 @@ static BOOL import_dll( HMODULE module, const IMAGE_IMPORT_DESCRIPTOR *descr, LP
     PVOID protect_base;
     SIZE_T protect_size = 0;
     DWORD protect_old;
+    ULONGLONG start = 0;
 
     thunk_list = get_rva( module, (DWORD)descr->FirstThunk );
     if (descr->u.OriginalFirstThunk)
@@ -709,6 +790,12 @@ static BOOL import_dll( HMODULE module, const IMAGE_IMPORT_DESCRIPTOR *descr, LP
         return FALSE;
     }
 
+    if (TRACE_ON(loadtime))
+    {
+        start = loadtime_now();
+        loadtime_depth++;
+    }
+
     /* unprotect the import address table since it can be located in
      * readonly section */
     while (import_list[protect_size].u1.Ordinal) protect_size++;
@@ -787,6 +874,15 @@ static BOOL import_dll( HMODULE module, const IMAGE_IMPORT_DESCRIPTOR *descr, LP
 done:
     /* restore old protection of the import address table */
     NtProtectVirtualMemory( NtCurrentProcess(), &protect_base, &protect_size, protect_old, &protect_old );
+    if (start)
+    {
+        ULONGLONG elapsed = loadtime_now() - start;
+        /* nested loads through forwarded exports are already accounted for */
+        if (!--loadtime_depth) loadtime_resolve += elapsed;
+        TRACE_(loadtime)( "%s: resolved imports from %s in %s us\n",
+                          debugstr_w(current_modref->ldr.BaseDllName.Buffer), name,
+                          wine_dbgstr_longlong(elapsed) );
+    }
     *pwm = wmImp;
     return TRUE;
 }
@@ -1311,10 +1407,24 @@ static NTSTATUS process_attach( WINE_MODREF *wm, LPVOID lpReserved )
     if (status == STATUS_SUCCESS)
     {
         WINE_MODREF *prev = current_modref;
-        current_modref = wm;
+        ULONGLONG start = 0;
 
+        current_modref = wm;
+        if (TRACE_ON(loadtime))
+        {
+            start = loadtime_now();
+            loadtime_depth++;
+        }
         call_ldr_notifications( LDR_DLL_NOTIFICATION_REASON_LOADED, &wm->ldr );
         status = MODULE_InitDLL( wm, DLL_PROCESS_ATTACH, lpReserved );
+        if (start)
+        {
+            ULONGLONG elapsed = loadtime_now() - start;
+            /* dlls loaded from DllMain are included in the time of their loader */
+            if (!--loadtime_depth) loadtime_init += elapsed;
+            TRACE_(loadtime)( "%s: process attach took %s us\n",
+                              debugstr_w(wm->ldr.BaseDllName.Buffer), wine_dbgstr_longlong(elapsed) );
+        }
         if (status == STATUS_SUCCESS)
         {
             wm->ldr.Flags |= LDR_PROCESS_ATTACHED;
@@ -1996,16 +2106,27 @@ static NTSTATUS load_native_dll( LPCWSTR load_path, const UNICODE_STRING *nt_nam
     IMAGE_NT_HEADERS *nt = RtlImageNtHeader( module );
     WINE_MODREF *wm;
     NTSTATUS status;
+    ULONGLONG start = 0;
 
     TRACE("Trying native dll %s\n", debugstr_us(nt_name));
 
     /* perform base relocation, if necessary */
 
+    if (TRACE_ON(loadtime)) start = loadtime_now();
     if ((status = perform_relocations( module, nt, image_info->map_size )))
     {
         NtUnmapViewOfSection( NtCurrentProcess(), module );
         return status;
     }
+    if (start)
+    {
+        ULONGLONG elapsed = loadtime_now() - start;
+        /* relocations of dlls loaded while resolving imports or from DllMain
+         * are already included in the time of their loader */
+        if (!loadtime_depth) loadtime_relocs += elapsed;
+        TRACE_(loadtime)( "%s: relocations took %s us\n",
+                          debugstr_us(nt_name), wine_dbgstr_longlong(elapsed) );
+    }
 
     /* create the MODREF */
 
@@ -3016,6 +3137,8 @@ void WINAPI LdrShutdownProcess(void)
     TRACE("()\n");
     process_detaching = TRUE;
     process_detach();
+    heap_dump_all_stats();
+    crit_dump_all_stats();
 }
 
 
@@ -3110,6 +3233,7 @@ static void free_modref( WINE_MODREF *wm )
     if (cached_modref == wm) cached_modref = NULL;
     RtlFreeUnicodeString( &wm->ldr.FullDllName );
     RtlFreeHeap( GetProcessHeap(), 0, wm->deps );
+    RtlFreeHeap( GetProcessHeap(), 0, wm->export_hash );
     RtlFreeHeap( GetProcessHeap(), 0, wm );
 }
 
@@ -3258,6 +3382,7 @@ void WINAPI LdrInitializeThunk( CONTEXT *context, void **entry, ULONG_PTR unknow
     NTSTATUS status;
     WINE_MODREF *wm;
     LPCWSTR load_path = NtCurrentTeb()->Peb->ProcessParameters->DllPath.Buffer;
+    ULONGLONG start = TRACE_ON(loadtime) ? loadtime_now() : 0, imports_time = 0;
 
     pthread_sigmask( SIG_UNBLOCK, &server_block_set, NULL );
 
@@ -3283,6 +3408,7 @@ void WINAPI LdrInitializeThunk( CONTEXT *context, void **entry, ULONG_PTR unknow
             NtTerminateProcess( GetCurrentProcess(), status );
         }
         imports_fixup_done = TRUE;
+        if (start) imports_time = loadtime_now() - start;
     }
 
     RtlAcquirePebLock();
@@ -3308,6 +3434,14 @@ void WINAPI LdrInitializeThunk( CONTEXT *context, void **entry, ULONG_PTR unknow
         }
         attach_implicitly_loaded_dlls( context );
         virtual_release_address_space();
+
+        if (start)
+            TRACE_(loadtime)( "%s: startup took %s us, imports %s us (resolving %s us, relocations %s us), "
+                              "process attach %s us\n",
+                              debugstr_w(wm->ldr.BaseDllName.Buffer),
+                              wine_dbgstr_longlong(loadtime_now() - start),
+                              wine_dbgstr_longlong(imports_time), wine_dbgstr_longlong(loadtime_resolve),
+                              wine_dbgstr_longlong(loadtime_relocs), wine_dbgstr_longlong(loadtime_init) );
     }
     else
     {
@@ -80,6 +80,8 @@ extern void virtual_init(void) DECLSPEC_HIDDEN;
 extern void virtual_init_threading(void) DECLSPEC_HIDDEN;
 extern void fill_cpu_info(void) DECLSPEC_HIDDEN;
 extern void heap_set_debug_flags( HANDLE handle ) DECLSPEC_HIDDEN;
+extern void heap_dump_all_stats(void) DECLSPEC_HIDDEN;
+extern void crit_dump_all_stats(void) DECLSPEC_HIDDEN;
 extern void init_user_process_params( SIZE_T data_size ) DECLSPEC_HIDDEN;
 extern void update_user_process_params( const UNICODE_STRING *image ) DECLSPEC_HIDDEN;
 
@@ -83,6 +83,7 @@
 #include "ntdll_misc.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(server);
+WINE_DECLARE_DEBUG_CHANNEL(fdcache);
 
 /* Some versions of glibc don't define this */
 #ifndef SCM_RIGHTS
@@ -270,9 +271,36 @@ static void read_reply_data( void *buffer, size_t size )
  */
 static inline unsigned int wait_reply( struct __server_request_info *req )
 {
-    read_reply_data( &req->u.reply, sizeof(req->u.reply) );
-    if (req->u.reply.reply_header.reply_size)
-        read_reply_data( req->reply_data, req->u.reply.reply_header.reply_size );
+    struct iovec vec[2];
+    data_size_t size;
+    int ret;
+
+    if (!req->u.req.request_header.reply_size)
+    {
+        read_reply_data( &req->u.reply, sizeof(req->u.reply) );
+        return req->u.reply.reply_header.error;
+    }
+
+    /* the server sends the header and the data with a single writev,
+     * so try to fetch both with a single syscall too */
+    vec[0].iov_base = &req->u.reply;
+    vec[0].iov_len  = sizeof(req->u.reply);
+    vec[1].iov_base = req->reply_data;
+    vec[1].iov_len  = req->u.req.request_header.reply_size;
+    while ((ret = readv( ntdll_get_thread_data()->reply_fd, vec, 2 )) == -1 && errno == EINTR);
+
+    if (ret < (int)sizeof(req->u.reply))
+    {
+        if (ret == -1 && errno != EPIPE) server_protocol_perror( "read" );
+        if (ret <= 0) abort_thread(0);
+        read_reply_data( (char *)&req->u.reply + ret, sizeof(req->u.reply) - ret );
+        ret = 0;
+    }
+    else ret -= sizeof(req->u.reply);
+
+    size = req->u.reply.reply_header.reply_size;
+    if ((data_size_t)ret > size) server_protocol_error( "partial read %d\n", ret );
+    if (size > (data_size_t)ret) read_reply_data( (char *)req->reply_data + ret, size - ret );
     return req->u.reply.reply_header.error;
 }
 
@@ -828,6 +856,11 @@ C_ASSERT( sizeof(union fd_cache_entry) == sizeof(LONG64) );
 static union fd_cache_entry *fd_cache[FD_CACHE_ENTRIES];
 static union fd_cache_entry fd_cache_initial_block[FD_CACHE_BLOCK_SIZE];
 
+/* cache statistics, only maintained when the fdcache channel is enabled */
+static LONG fd_cache_hits;
+static LONG fd_cache_misses;
+static LONG fd_cache_server_errors;
+
 static inline unsigned int handle_to_index( HANDLE handle, unsigned int *entry )
 {
     unsigned int idx = (wine_server_obj_handle(handle) >> 2) - 1;
@@ -887,7 +920,13 @@ static inline NTSTATUS get_cached_fd( HANDLE handle, int *fd, enum server_fd_typ
 
     if (entry >= FD_CACHE_ENTRIES || !fd_cache[entry]) return STATUS_INVALID_HANDLE;
 
+    /* readers must not write to the shared cache line, so avoid a locked
+     * instruction where a plain aligned 64-bit load is already atomic */
+#ifdef _WIN64
+    cache.data = *(volatile LONG64 *)&fd_cache[entry][idx].data;
+#else
     cache.data = interlocked_cmpxchg64( &fd_cache[entry][idx].data, 0, 0 );
+#endif
     if (!cache.data) return STATUS_INVALID_HANDLE;
 
     /* if fd type is invalid, fd stores an error value */
@@ -938,12 +977,23 @@ int server_get_unix_fd( HANDLE handle, unsigned int wanted_access, int *unix_fd,
     wanted_access &= FILE_READ_DATA | FILE_WRITE_DATA | FILE_APPEND_DATA;
 
     ret = get_cached_fd( handle, &fd, type, &access, options );
-    if (ret != STATUS_INVALID_HANDLE) goto done;
+    if (ret != STATUS_INVALID_HANDLE)
+    {
+        if (TRACE_ON(fdcache)) interlocked_xchg_add( &fd_cache_hits, 1 );
+        goto done;
+    }
 
     server_enter_uninterrupted_section( &fd_cache_section, &sigset );
     ret = get_cached_fd( handle, &fd, type, &access, options );
     if (ret == STATUS_INVALID_HANDLE)
     {
+        if (TRACE_ON(fdcache))
+        {
+            LONG misses = interlocked_xchg_add( &fd_cache_misses, 1 ) + 1;
+            TRACE_(fdcache)( "handle %p not cached, %d hits, %d misses, %d server errors\n", handle,
+                             fd_cache_hits, misses, fd_cache_server_errors );
+        }
+
         SERVER_START_REQ( get_handle_fd )
         {
             req->handle = wine_server_obj_handle( handle );
@@ -967,6 +1017,7 @@ int server_get_unix_fd( HANDLE handle, unsigned int wanted_access, int *unix_fd,
             }
         }
         SERVER_END_REQ;
+        if (ret && TRACE_ON(fdcache)) interlocked_xchg_add( &fd_cache_server_errors, 1 );
     }
     server_leave_uninterrupted_section( &fd_cache_section, &sigset );
 
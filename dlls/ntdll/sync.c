@@ -85,6 +85,8 @@ static inline int interlocked_dec_if_nonzero( int *dest )
 
 static int wait_op = 128; /*FUTEX_WAIT|FUTEX_PRIVATE_FLAG*/
 static int wake_op = 129; /*FUTEX_WAKE|FUTEX_PRIVATE_FLAG*/
+static int wait_bitset_op = 137; /*FUTEX_WAIT_BITSET|FUTEX_PRIVATE_FLAG*/
+static int wake_bitset_op = 138; /*FUTEX_WAKE_BITSET|FUTEX_PRIVATE_FLAG*/
 
 static inline int futex_wait( const int *addr, int val, struct timespec *timeout )
 {
@@ -96,6 +98,16 @@ static inline int futex_wake( const int *addr, int val )
     return syscall( __NR_futex, addr, wake_op, val, NULL, 0, 0 );
 }
 
+static inline int futex_wait_bitset( const int *addr, int val, struct timespec *timeout, int mask )
+{
+    return syscall( __NR_futex, addr, wait_bitset_op, val, timeout, 0, mask );
+}
+
+static inline int futex_wake_bitset( const int *addr, int val, int mask )
+{
+    return syscall( __NR_futex, addr, wake_bitset_op, val, NULL, 0, mask );
+}
+
 static inline int use_futexes(void)
 {
     static int supported = -1;
@@ -107,6 +119,8 @@ static inline int use_futexes(void)
         {
             wait_op = 0; /*FUTEX_WAIT*/
             wake_op = 1; /*FUTEX_WAKE*/
+            wait_bitset_op = 9; /*FUTEX_WAIT_BITSET*/
+            wake_bitset_op = 10; /*FUTEX_WAKE_BITSET*/
             futex_wait( &supported, 10, NULL );
         }
         supported = (errno != ENOSYS);
@@ -114,6 +128,21 @@ static inline int use_futexes(void)
     return supported;
 }
 
+static inline int use_futex_bitsets(void)
+{
+    static int supported = -1;
+
+    if (supported == -1)
+    {
+        int val = 0;
+
+        if (!use_futexes()) supported = 0;
+        else supported = (futex_wait_bitset( &val, 1, NULL, ~0 ) == -1 && errno == EAGAIN &&
+                          futex_wake_bitset( &val, 1, ~0 ) != -1);
+    }
+    return supported;
+}
+
 static void timespec_from_timeout( struct timespec *timespec, const LARGE_INTEGER *timeout )
 {
     LARGE_INTEGER now;
@@ -1402,8 +1431,9 @@ NTSTATUS WINAPI NtRemoveIoCompletion( HANDLE CompletionPort, PULONG_PTR Completi
 NTSTATUS WINAPI NtRemoveIoCompletionEx( HANDLE port, FILE_IO_COMPLETION_INFORMATION *info, ULONG count,
                                         ULONG *written, LARGE_INTEGER *timeout, BOOLEAN alertable )
 {
+    struct completion_entry entries[64];
     NTSTATUS ret;
-    ULONG i = 0;
+    ULONG i = 0, j, size, received;
 
     TRACE("%p %p %u %p %p %u\n", port, info, count, written, timeout, alertable);
 
@@ -1411,22 +1441,30 @@ NTSTATUS WINAPI NtRemoveIoCompletionEx( HANDLE port, FILE_IO_COMPLETION_INFORMAT
     {
         while (i < count)
         {
-            SERVER_START_REQ( remove_completion )
+            size = min( count - i, ARRAY_SIZE(entries) );
+            received = 0;
+
+            SERVER_START_REQ( remove_completions )
             {
                 req->handle = wine_server_obj_handle( port );
+                wine_server_set_reply( req, entries, size * sizeof(*entries) );
                 if (!(ret = wine_server_call( req )))
-                {
-                    info[i].CompletionKey             = reply->ckey;
-                    info[i].CompletionValue           = reply->cvalue;
-                    info[i].IoStatusBlock.Information = reply->information;
-                    info[i].IoStatusBlock.u.Status    = reply->status;
-                }
+                    received = wine_server_reply_size( reply ) / sizeof(*entries);
             }
             SERVER_END_REQ;
 
             if (ret != STATUS_SUCCESS) break;
 
-            ++i;
+            for (j = 0; j < received; j++, i++)
+            {
+                info[i].CompletionKey             = entries[j].ckey;
+                info[i].CompletionValue           = entries[j].cvalue;
+                info[i].IoStatusBlock.Information = entries[j].information;
+                info[i].IoStatusBlock.u.Status    = entries[j].status;
+            }
+
+            /* the queue has been drained */
+            if (received < size) break;
         }
 
         if (i || ret != STATUS_PENDING)
@@ -1783,15 +1821,229 @@ static inline void srwlock_leave_shared( RTL_SRWLOCK *lock, unsigned int val )
         NtReleaseKeyedEvent( 0, srwlock_key_exclusive(lock), FALSE, NULL );
 }
 
+#ifdef __linux__
+
+/* When futexes are available the lock word uses a different layout, and
+ * waiters block directly on it instead of going through keyed events:
+ *  ______________ ___________________ ___________________ ________________
+ * | exclusive bit | shared waiters bit | #exclusive waiters | #shared owners |
+ *  ¯¯¯¯¯¯¯¯¯¯¯¯¯¯ ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯ ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯ ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * Exclusive waiters take precedence over new shared owners, and releasing
+ * the lock wakes a single exclusive waiter, so that writers are neither
+ * starved nor woken as a herd. Exclusive waiters are woken in the order
+ * the kernel queues them on the futex, which is FIFO for threads of the
+ * same priority, but a thread arriving while the lock is free can still
+ * take it first. Shared and exclusive waiters sleep on
+ * distinct futex bitsets, shared waiters are only woken all at once when
+ * no writer is queued, and only if one of them flagged itself as sleeping. */
+
+#define SRWLOCK_FUTEX_EXCLUSIVE_LOCK_BIT        0x80000000
+#define SRWLOCK_FUTEX_SHARED_WAITERS_BIT        0x40000000
+#define SRWLOCK_FUTEX_EXCLUSIVE_WAITERS_MASK    0x3fff0000
+#define SRWLOCK_FUTEX_EXCLUSIVE_WAITERS_INC     0x00010000
+#define SRWLOCK_FUTEX_SHARED_OWNERS_MASK        0x0000ffff
+#define SRWLOCK_FUTEX_SHARED_OWNERS_INC         0x00000001
+
+/* futex bitsets, independent from the bits of the lock word */
+#define SRWLOCK_FUTEX_BITSET_EXCLUSIVE          1
+#define SRWLOCK_FUTEX_BITSET_SHARED             2
+
+static inline int *srwlock_get_futex( RTL_SRWLOCK *lock )
+{
+    if (!use_futex_bitsets() || ((ULONG_PTR)&lock->Ptr & 3)) return NULL;
+    return (int *)&lock->Ptr;
+}
+
+static NTSTATUS fast_try_acquire_srw_exclusive( RTL_SRWLOCK *lock )
+{
+    int *futex;
+
+    if (!(futex = srwlock_get_futex( lock ))) return STATUS_NOT_IMPLEMENTED;
+
+    if (interlocked_cmpxchg( futex, SRWLOCK_FUTEX_EXCLUSIVE_LOCK_BIT, 0 )) return STATUS_TIMEOUT;
+    return STATUS_SUCCESS;
+}
+
+static NTSTATUS fast_acquire_srw_exclusive( RTL_SRWLOCK *lock )
+{
+    unsigned int old, new;
+    BOOL wait;
+    int *futex;
+
+    if (!(futex = srwlock_get_futex( lock ))) return STATUS_NOT_IMPLEMENTED;
+
+    if (!interlocked_cmpxchg( futex, SRWLOCK_FUTEX_EXCLUSIVE_LOCK_BIT, 0 )) return STATUS_SUCCESS;
+
+    /* register as an exclusive waiter, this blocks new shared owners */
+    do
+    {
+        old = *futex;
+        new = old + SRWLOCK_FUTEX_EXCLUSIVE_WAITERS_INC;
+        if (!(new & SRWLOCK_FUTEX_EXCLUSIVE_WAITERS_MASK)) RtlRaiseStatus( STATUS_RESOURCE_NOT_OWNED );
+    } while (interlocked_cmpxchg( futex, new, old ) != old);
+
+    for (;;)
+    {
+        do
+        {
+            old = *futex;
+            if (!(old & SRWLOCK_FUTEX_EXCLUSIVE_LOCK_BIT) && !(old & SRWLOCK_FUTEX_SHARED_OWNERS_MASK))
+            {
+                new = (old | SRWLOCK_FUTEX_EXCLUSIVE_LOCK_BIT) - SRWLOCK_FUTEX_EXCLUSIVE_WAITERS_INC;
+                wait = FALSE;
+            }
+            else
+            {
+                new = old;
+                wait = TRUE;
+            }
+        } while (interlocked_cmpxchg( futex, new, old ) != old);
+
+        if (!wait) return STATUS_SUCCESS;
+        futex_wait_bitset( futex, new, NULL, SRWLOCK_FUTEX_BITSET_EXCLUSIVE );
+    }
+}
+
+static NTSTATUS fast_try_acquire_srw_shared( RTL_SRWLOCK *lock )
+{
+    unsigned int old, new;
+    int *futex;
+
+    if (!(futex = srwlock_get_futex( lock ))) return STATUS_NOT_IMPLEMENTED;
+
+    do
+    {
+        old = *futex;
+        if ((old & (SRWLOCK_FUTEX_EXCLUSIVE_LOCK_BIT | SRWLOCK_FUTEX_EXCLUSIVE_WAITERS_MASK)))
+            return STATUS_TIMEOUT;
+        new = old + SRWLOCK_FUTEX_SHARED_OWNERS_INC;
+        if (!(new & SRWLOCK_FUTEX_SHARED_OWNERS_MASK)) RtlRaiseStatus( STATUS_RESOURCE_NOT_OWNED );
+    } while (interlocked_cmpxchg( futex, new, old ) != old);
+
+    return STATUS_SUCCESS;
+}
+
+static NTSTATUS fast_acquire_srw_shared( RTL_SRWLOCK *lock )
+{
+    unsigned int old, new;
+    BOOL wait;
+    int *futex;
+
+    if (!(futex = srwlock_get_futex( lock ))) return STATUS_NOT_IMPLEMENTED;
+
+    for (;;)
+    {
+        do
+        {
+            old = *futex;
+            /* queued exclusive waiters take precedence */
+            if (!(old & (SRWLOCK_FUTEX_EXCLUSIVE_LOCK_BIT | SRWLOCK_FUTEX_EXCLUSIVE_WAITERS_MASK)))
+            {
+                new = old + SRWLOCK_FUTEX_SHARED_OWNERS_INC;
+                if (!(new & SRWLOCK_FUTEX_SHARED_OWNERS_MASK)) RtlRaiseStatus( STATUS_RESOURCE_NOT_OWNED );
+                wait = FALSE;
+            }
+            else
+            {
+                new = old | SRWLOCK_FUTEX_SHARED_WAITERS_BIT;
+                wait = TRUE;
+            }
+        } while (interlocked_cmpxchg( futex, new, old ) != old);
+
+        if (!wait) return STATUS_SUCCESS;
+        futex_wait_bitset( futex, new, NULL, SRWLOCK_FUTEX_BITSET_SHARED );
+    }
+}
+
+static NTSTATUS fast_release_srw_exclusive( RTL_SRWLOCK *lock )
+{
+    unsigned int old, new;
+    int *futex;
+
+    if (!(futex = srwlock_get_futex( lock ))) return STATUS_NOT_IMPLEMENTED;
+
+    do
+    {
+        old = *futex;
+        if (!(old & SRWLOCK_FUTEX_EXCLUSIVE_LOCK_BIT)) RtlRaiseStatus( STATUS_RESOURCE_NOT_OWNED );
+        new = old & ~SRWLOCK_FUTEX_EXCLUSIVE_LOCK_BIT;
+        /* shared waiters are woken below, they flag themselves again if they have to wait */
+        if (!(new & SRWLOCK_FUTEX_EXCLUSIVE_WAITERS_MASK)) new &= ~SRWLOCK_FUTEX_SHARED_WAITERS_BIT;
+    } while (interlocked_cmpxchg( futex, new, old ) != old);
+
+    if (new & SRWLOCK_FUTEX_EXCLUSIVE_WAITERS_MASK)
+        futex_wake_bitset( futex, 1, SRWLOCK_FUTEX_BITSET_EXCLUSIVE );
+    else if (old & SRWLOCK_FUTEX_SHARED_WAITERS_BIT)
+        futex_wake_bitset( futex, INT_MAX, SRWLOCK_FUTEX_BITSET_SHARED );
+    return STATUS_SUCCESS;
+}
+
+static NTSTATUS fast_release_srw_shared( RTL_SRWLOCK *lock )
+{
+    unsigned int old, new;
+    int *futex;
+
+    if (!(futex = srwlock_get_futex( lock ))) return STATUS_NOT_IMPLEMENTED;
+
+    do
+    {
+        old = *futex;
+        if ((old & SRWLOCK_FUTEX_EXCLUSIVE_LOCK_BIT) || !(old & SRWLOCK_FUTEX_SHARED_OWNERS_MASK))
+            RtlRaiseStatus( STATUS_RESOURCE_NOT_OWNED );
+        new = old - SRWLOCK_FUTEX_SHARED_OWNERS_INC;
+    } while (interlocked_cmpxchg( futex, new, old ) != old);
+
+    /* the last reader hands the lock over to a single writer */
+    if (!(new & SRWLOCK_FUTEX_SHARED_OWNERS_MASK) && (new & SRWLOCK_FUTEX_EXCLUSIVE_WAITERS_MASK))
+        futex_wake_bitset( futex, 1, SRWLOCK_FUTEX_BITSET_EXCLUSIVE );
+    return STATUS_SUCCESS;
+}
+
+#else
+
+static NTSTATUS fast_try_acquire_srw_exclusive( RTL_SRWLOCK *lock )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+static NTSTATUS fast_acquire_srw_exclusive( RTL_SRWLOCK *lock )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+static NTSTATUS fast_try_acquire_srw_shared( RTL_SRWLOCK *lock )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+static NTSTATUS fast_acquire_srw_shared( RTL_SRWLOCK *lock )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+static NTSTATUS fast_release_srw_exclusive( RTL_SRWLOCK *lock )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+static NTSTATUS fast_release_srw_shared( RTL_SRWLOCK *lock )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+#endif
+
 /***********************************************************************
  *              RtlInitializeSRWLock (NTDLL.@)
  *
  * NOTES
  *  Please note that SRWLocks do not keep track of the owner of a lock.
  *  It doesn't make any difference which thread for example unlocks an
- *  SRWLock (see corresponding tests). This implementation uses two
- *  keyed events (one for the exclusive waiters and one for the shared
- *  waiters) and is limited to 2^15-1 waiting threads.
+ *  SRWLock (see corresponding tests). This implementation uses futexes
+ *  where available, and is then limited to 2^14-1 exclusive waiters and
+ *  2^16-1 shared owners. Otherwise it uses two keyed events (one for the
+ *  exclusive waiters and one for the shared waiters), and is limited to
+ *  2^15-1 waiting threads.
  */
 void WINAPI RtlInitializeSRWLock( RTL_SRWLOCK *lock )
 {
@@ -1808,6 +2060,9 @@ void WINAPI RtlInitializeSRWLock( RTL_SRWLOCK *lock )
  */
 void WINAPI RtlAcquireSRWLockExclusive( RTL_SRWLOCK *lock )
 {
+    if (fast_acquire_srw_exclusive( lock ) != STATUS_NOT_IMPLEMENTED)
+        return;
+
     if (srwlock_lock_exclusive( (unsigned int *)&lock->Ptr, SRWLOCK_RES_EXCLUSIVE ))
         NtWaitForKeyedEvent( 0, srwlock_key_exclusive(lock), FALSE, NULL );
 }
@@ -1822,6 +2077,10 @@ void WINAPI RtlAcquireSRWLockExclusive( RTL_SRWLOCK *lock )
 void WINAPI RtlAcquireSRWLockShared( RTL_SRWLOCK *lock )
 {
     unsigned int val, tmp;
+
+    if (fast_acquire_srw_shared( lock ) != STATUS_NOT_IMPLEMENTED)
+        return;
+
     /* Acquires a shared lock. If it's currently not possible to add elements to
      * the shared queue, then request exclusive access instead. */
     for (val = *(unsigned int *)&lock->Ptr;; val = tmp)
@@ -1852,6 +2111,9 @@ void WINAPI RtlAcquireSRWLockShared( RTL_SRWLOCK *lock )
  */
 void WINAPI RtlReleaseSRWLockExclusive( RTL_SRWLOCK *lock )
 {
+    if (fast_release_srw_exclusive( lock ) != STATUS_NOT_IMPLEMENTED)
+        return;
+
     srwlock_leave_exclusive( lock, srwlock_unlock_exclusive( (unsigned int *)&lock->Ptr,
                              - SRWLOCK_RES_EXCLUSIVE ) - SRWLOCK_RES_EXCLUSIVE );
 }
@@ -1861,6 +2123,9 @@ void WINAPI RtlReleaseSRWLockExclusive( RTL_SRWLOCK *lock )
  */
 void WINAPI RtlReleaseSRWLockShared( RTL_SRWLOCK *lock )
 {
+    if (fast_release_srw_shared( lock ) != STATUS_NOT_IMPLEMENTED)
+        return;
+
     srwlock_leave_shared( lock, srwlock_lock_exclusive( (unsigned int *)&lock->Ptr,
                           - SRWLOCK_RES_SHARED ) - SRWLOCK_RES_SHARED );
 }
@@ -1874,6 +2139,11 @@ void WINAPI RtlReleaseSRWLockShared( RTL_SRWLOCK *lock )
  */
 BOOLEAN WINAPI RtlTryAcquireSRWLockExclusive( RTL_SRWLOCK *lock )
 {
+    NTSTATUS ret;
+
+    if ((ret = fast_try_acquire_srw_exclusive( lock )) != STATUS_NOT_IMPLEMENTED)
+        return (ret == STATUS_SUCCESS);
+
     return interlocked_cmpxchg( (int *)&lock->Ptr, SRWLOCK_MASK_IN_EXCLUSIVE |
                                 SRWLOCK_RES_EXCLUSIVE, 0 ) == 0;
 }
@@ -1884,6 +2154,11 @@ BOOLEAN WINAPI RtlTryAcquireSRWLockExclusive( RTL_SRWLOCK *lock )
 BOOLEAN WINAPI RtlTryAcquireSRWLockShared( RTL_SRWLOCK *lock )
 {
     unsigned int val, tmp;
+    NTSTATUS ret;
+
+    if ((ret = fast_try_acquire_srw_shared( lock )) != STATUS_NOT_IMPLEMENTED)
+        return (ret == STATUS_SUCCESS);
+
     for (val = *(unsigned int *)&lock->Ptr;; val = tmp)
     {
         if (val & SRWLOCK_MASK_EXCLUSIVE_QUEUE)
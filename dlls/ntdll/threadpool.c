@@ -114,6 +114,7 @@ struct timer_queue
  */
 
 #define THREADPOOL_WORKER_TIMEOUT 5000
+#define THREADPOOL_SAMPLE_INTERVAL 1000
 #define MAXIMUM_WAITQUEUE_OBJECTS (MAXIMUM_WAIT_OBJECTS - 1)
 
 /* internal threadpool representation */
@@ -131,6 +132,13 @@ struct threadpool
     int                     min_workers;
     int                     num_workers;
     int                     num_busy_workers;
+    int                     num_long_workers;
+    /* concurrency control, locked via .cs */
+    int                     target_workers;
+    int                     sample_peak;
+    ULONG                   sample_completed;
+    ULONG                   sample_start;
+    ULONG                   last_throughput;
 };
 
 enum threadpool_objtype
@@ -329,6 +337,7 @@ static void CALLBACK threadpool_worker_proc( void *param );
 static void tp_object_submit( struct threadpool_object *object, BOOL signaled );
 static void tp_object_prepare_shutdown( struct threadpool_object *object );
 static BOOL tp_object_release( struct threadpool_object *object );
+static BOOL tp_threadpool_release( struct threadpool *pool );
 static struct threadpool *default_threadpool = NULL;
 
 static inline LONG interlocked_inc( PLONG dest )
@@ -1317,6 +1326,53 @@ static NTSTATUS tp_new_worker_thread( struct threadpool *pool )
     return status;
 }
 
+/***********************************************************************
+ *           tp_reserve_worker_thread    (internal)
+ *
+ * Accounts a new worker thread for the desired pool. Has to be called
+ * with pool->cs held; the thread itself is started afterwards with
+ * tp_start_worker_thread, outside of the critical section.
+ */
+static void tp_reserve_worker_thread( struct threadpool *pool )
+{
+    interlocked_inc( &pool->refcount );
+    pool->num_workers++;
+    pool->num_busy_workers++;
+}
+
+/***********************************************************************
+ *           tp_start_worker_thread    (internal)
+ *
+ * Starts a worker thread previously reserved with tp_reserve_worker_thread.
+ * Creating a thread requires a wineserver round-trip, so this must not be
+ * done while holding pool->cs.
+ */
+static void tp_start_worker_thread( struct threadpool *pool )
+{
+    HANDLE thread;
+    NTSTATUS status;
+
+    status = RtlCreateUserThread( GetCurrentProcess(), NULL, FALSE, NULL, 0, 0,
+                                  threadpool_worker_proc, pool, &thread, NULL );
+    if (status == STATUS_SUCCESS)
+    {
+        NtClose( thread );
+        return;
+    }
+
+    WARN( "failed to create worker thread for pool %p, status %x\n", pool, status );
+
+    RtlEnterCriticalSection( &pool->cs );
+    pool->num_workers--;
+    pool->num_busy_workers--;
+    assert( pool->num_workers > 0 );
+    RtlLeaveCriticalSection( &pool->cs );
+
+    /* Let one of the existing threads pick up the queued work item. */
+    RtlWakeConditionVariable( &pool->update_event );
+    tp_threadpool_release( pool );
+}
+
 /***********************************************************************
  *           tp_timerqueue_lock    (internal)
  *
@@ -1667,6 +1723,13 @@ static NTSTATUS tp_threadpool_alloc( struct threadpool **out )
     pool->min_workers           = 0;
     pool->num_workers           = 0;
     pool->num_busy_workers      = 0;
+    pool->num_long_workers      = 0;
+
+    pool->target_workers        = 0;
+    pool->sample_peak           = 0;
+    pool->sample_completed      = 0;
+    pool->sample_start          = NtGetTickCount();
+    pool->last_throughput       = 0;
 
     TRACE( "allocated threadpool %p\n", pool );
 
@@ -1712,6 +1775,50 @@ static BOOL tp_threadpool_release( struct threadpool *pool )
     return TRUE;
 }
 
+/***********************************************************************
+ *           tp_threadpool_sample    (internal)
+ *
+ * Updates the concurrency target of a threadpool. Has to be called with
+ * pool->cs held. Callbacks which declared themselves as long running
+ * don't count towards the demand, they are expected to block and get a
+ * thread on their own. The target follows the peak demand upwards
+ * immediately, and decays by one thread per sample interval while the
+ * demand stays below it. Idle threads above the target are reaped.
+ */
+static void tp_threadpool_sample( struct threadpool *pool )
+{
+    ULONG now = NtGetTickCount(), elapsed = now - pool->sample_start;
+    int busy = pool->num_busy_workers - pool->num_long_workers;
+    ULONG throughput;
+    int target;
+
+    pool->sample_peak = max( pool->sample_peak, busy );
+    if (elapsed < THREADPOOL_SAMPLE_INTERVAL)
+        return;
+
+    throughput = (ULONGLONG)pool->sample_completed * 1000 / elapsed;
+    target = pool->target_workers;
+
+    if (pool->sample_peak > target)
+        target = pool->sample_peak;
+    else if (pool->sample_peak < target && throughput <= pool->last_throughput)
+        target--;
+
+    target = max( target, pool->min_workers );
+    target = min( target, pool->max_workers );
+
+    if (target != pool->target_workers)
+        TRACE( "pool %p: target %d -> %d, throughput %u/s (was %u/s), peak %d, workers %d (%d long running)\n",
+               pool, pool->target_workers, target, throughput, pool->last_throughput,
+               pool->sample_peak, pool->num_workers, pool->num_long_workers );
+
+    pool->target_workers    = target;
+    pool->last_throughput   = throughput;
+    pool->sample_peak       = busy;
+    pool->sample_completed  = 0;
+    pool->sample_start      = now;
+}
+
 /***********************************************************************
  *           tp_threadpool_lock    (internal)
  *
@@ -1925,7 +2032,7 @@ static void tp_object_initialize( struct threadpool_object *object, struct threa
 static void tp_object_submit( struct threadpool_object *object, BOOL signaled )
 {
     struct threadpool *pool = object->pool;
-    NTSTATUS status = STATUS_UNSUCCESSFUL;
+    BOOL new_thread = FALSE, wake = FALSE;
 
     assert( !object->shutdown );
     assert( !pool->shutdown );
@@ -1935,7 +2042,10 @@ static void tp_object_submit( struct threadpool_object *object, BOOL signaled )
     /* Start new worker threads if required. */
     if (pool->num_busy_workers >= pool->num_workers &&
         pool->num_workers < pool->max_workers)
-        status = tp_new_worker_thread( pool );
+    {
+        tp_reserve_worker_thread( pool );
+        new_thread = TRUE;
+    }
 
     /* Queue work item and increment refcount. */
     interlocked_inc( &object->refcount );
@@ -1946,14 +2056,22 @@ static void tp_object_submit( struct threadpool_object *object, BOOL signaled )
     if (object->type == TP_OBJECT_TYPE_WAIT && signaled)
         object->u.wait.signaled++;
 
-    /* No new thread started - wake up one existing thread. */
-    if (status != STATUS_SUCCESS)
+    /* No new thread started - wake up one existing thread, but only if there
+     * is an idle one. Busy threads check the pool before going to sleep. */
+    if (!new_thread)
     {
         assert( pool->num_workers > 0 );
-        RtlWakeConditionVariable( &pool->update_event );
+        wake = pool->num_busy_workers < pool->num_workers;
     }
 
     RtlLeaveCriticalSection( &pool->cs );
+
+    /* Thread creation and wakeups are done outside of the critical section,
+     * so that the worker threads don't immediately block on pool->cs. */
+    if (new_thread)
+        tp_start_worker_thread( pool );
+    else if (wake)
+        RtlWakeConditionVariable( &pool->update_event );
 }
 
 /***********************************************************************
@@ -2102,6 +2220,8 @@ static void CALLBACK threadpool_worker_proc( void *param )
             object->num_associated_callbacks++;
             object->num_running_callbacks++;
             pool->num_busy_workers++;
+            if (object->may_run_long) pool->num_long_workers++;
+            tp_threadpool_sample( pool );
             RtlLeaveCriticalSection( &pool->cs );
 
             /* Initialize threadpool instance struct. */
@@ -2197,6 +2317,8 @@ static void CALLBACK threadpool_worker_proc( void *param )
         skip_cleanup:
             RtlEnterCriticalSection( &pool->cs );
             pool->num_busy_workers--;
+            if (instance.may_run_long) pool->num_long_workers--;
+            pool->sample_completed++;
 
             /* Simple callbacks are automatically shutdown after execution. */
             if (object->type == TP_OBJECT_TYPE_SIMPLE)
@@ -2225,15 +2347,22 @@ static void CALLBACK threadpool_worker_proc( void *param )
 
         /* Wait for new tasks or until the timeout expires. A thread only terminates
          * when no new tasks are available, and the number of threads can be
-         * decreased without violating the min_workers limit. An exception is when
-         * min_workers == 0, then objcount is used to detect if the last thread
-         * can be terminated. */
+         * decreased without violating the min_workers limit and the current
+         * concurrency target. An exception is when min_workers == 0, then
+         * objcount is used to detect if the last thread can be terminated. */
         timeout.QuadPart = (ULONGLONG)THREADPOOL_WORKER_TIMEOUT * -10000;
-        if (RtlSleepConditionVariableCS( &pool->update_event, &pool->cs, &timeout ) == STATUS_TIMEOUT &&
-            !list_head( &pool->pool ) && (pool->num_workers > max( pool->min_workers, 1 ) ||
-            (!pool->min_workers && !pool->objcount)))
+        if (RtlSleepConditionVariableCS( &pool->update_event, &pool->cs, &timeout ) == STATUS_TIMEOUT)
         {
-            break;
+            tp_threadpool_sample( pool );
+            if (!list_head( &pool->pool ) &&
+                ((pool->num_workers - pool->num_long_workers > max( pool->target_workers, 1 ) &&
+                  pool->num_workers > max( pool->min_workers, 1 )) ||
+                 (!pool->min_workers && !pool->objcount)))
+            {
+                TRACE( "pool %p: reaping idle worker, %d workers, target %d\n",
+                       pool, pool->num_workers, pool->target_workers );
+                break;
+            }
         }
     }
     pool->num_workers--;
@@ -2428,6 +2557,7 @@ NTSTATUS WINAPI TpCallbackMayRunLong( TP_CALLBACK_INSTANCE *instance )
         }
     }
 
+    pool->num_long_workers++;
     RtlLeaveCriticalSection( &pool->cs );
     this->may_run_long = TRUE;
     return status;
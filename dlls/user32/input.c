@@ -465,6 +465,11 @@ DWORD WINAPI GetQueueStatus( UINT flags )
 
     check_for_events( flags );
 
+    /* the bits to clear are not set either, no need to ask the server */
+    if (get_user_thread_info()->queue_status &&
+        !(get_user_thread_info()->queue_status->bits & MAKELONG( flags, flags )))
+        return 0;
+
     SERVER_START_REQ( get_queue_status )
     {
         req->clear_bits = flags;
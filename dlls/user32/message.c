@@ -2740,6 +2740,79 @@ static inline void call_sendmsg_callback( SENDASYNCPROC callback, HWND hwnd, UIN
 }
 
 
+/* used when the shared queue status is not available, prevents any shortcut */
+static struct queue_status queue_status_unavailable = { ~0u };
+
+/***********************************************************************
+ *           get_queue_status
+ *
+ * Map the section where the server publishes the bits of the thread queue.
+ */
+static struct queue_status *get_queue_status( struct user_thread_info *thread_info )
+{
+    obj_handle_t handle = 0;
+    SIZE_T size = 0;
+    void *ptr = NULL;
+
+    if (thread_info->queue_status) return thread_info->queue_status;
+
+    SERVER_START_REQ( get_msg_queue_status_section )
+    {
+        if (!wine_server_call( req ))
+        {
+            handle = reply->handle;
+            size   = reply->size;
+        }
+    }
+    SERVER_END_REQ;
+
+    if (handle && NtMapViewOfSection( wine_server_ptr_handle( handle ), GetCurrentProcess(), &ptr,
+                                      0, 0, NULL, &size, ViewShare, 0, PAGE_READWRITE ))
+        ptr = NULL;
+    if (handle) NtClose( wine_server_ptr_handle( handle ));
+
+    if (!ptr)
+    {
+        WARN( "shared queue status not available\n" );
+        ptr = &queue_status_unavailable;
+    }
+    return thread_info->queue_status = ptr;
+}
+
+
+/***********************************************************************
+ *           free_queue_status
+ */
+void free_queue_status( struct user_thread_info *thread_info )
+{
+    if (thread_info->queue_status && thread_info->queue_status != &queue_status_unavailable)
+        NtUnmapViewOfSection( GetCurrentProcess(), thread_info->queue_status );
+    thread_info->queue_status = NULL;
+}
+
+
+/***********************************************************************
+ *           is_queue_idle
+ *
+ * Check whether the server reports an empty queue, in which case a
+ * non-blocking peek doesn't need a server round trip.
+ */
+static BOOL is_queue_idle( struct user_thread_info *thread_info )
+{
+    struct queue_status *status = get_queue_status( thread_info );
+    DWORD now = GetTickCount();
+
+    if (status->bits) return FALSE;
+    /* still call the server regularly, so that the thread isn't considered hung */
+    if (now - status->last_get_msg >= 1000)
+    {
+        status->last_get_msg = now;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+
 /***********************************************************************
  *           peek_message
  *
@@ -2756,6 +2829,9 @@ static BOOL peek_message( MSG *msg, HWND hwnd, UINT first, UINT last, UINT flags
     void *buffer;
     size_t buffer_size = 256;
 
+    /* nothing to retrieve, and no need to update the wait masks */
+    if (!changed_mask && hwnd != (HWND)-1 && is_queue_idle( thread_info )) return FALSE;
+
     if (!(buffer = HeapAlloc( GetProcessHeap(), 0, buffer_size ))) return FALSE;
 
     if (!first && !last) last = ~0;
@@ -190,6 +190,7 @@ struct user_thread_info
     HWND                          top_window;             /* Desktop window */
     HWND                          msg_window;             /* HWND_MESSAGE parent window */
     RAWINPUT                     *rawinput;
+    struct queue_status          *queue_status;           /* Queue status shared with the server */
 };
 
 C_ASSERT( sizeof(struct user_thread_info) <= sizeof(((TEB *)0)->Win32ClientInfo) );
@@ -198,6 +199,13 @@ extern INT global_key_state_counter DECLSPEC_HIDDEN;
 extern BOOL (WINAPI *imm_register_window)(HWND) DECLSPEC_HIDDEN;
 extern void (WINAPI *imm_unregister_window)(HWND) DECLSPEC_HIDDEN;
 
+/* layout of the queue status section shared with the server */
+struct queue_status
+{
+    volatile DWORD                bits;                   /* Queue bits, written by the server */
+    DWORD                         last_get_msg;           /* Time of last get_message request */
+};
+
 struct user_key_state_info
 {
     UINT                          time;                   /* Time of last key state refresh */
@@ -228,6 +236,7 @@ struct dce;
 struct tagWND;
 
 extern void CLIPBOARD_ReleaseOwner( HWND hwnd ) DECLSPEC_HIDDEN;
+extern void free_queue_status( struct user_thread_info *thread_info ) DECLSPEC_HIDDEN;
 extern BOOL FOCUS_MouseActivate( HWND hwnd ) DECLSPEC_HIDDEN;
 extern BOOL set_capture_window( HWND hwnd, UINT gui_flags, HWND *prev_ret ) DECLSPEC_HIDDEN;
 extern void free_dce( struct dce *dce, HWND hwnd ) DECLSPEC_HIDDEN;
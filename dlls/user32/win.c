@@ -154,6 +154,79 @@ void *get_user_handle_ptr( HANDLE handle, enum user_obj_type type )
 }
 
 
+/***********************************************************************
+ *           get_shared_windows
+ *
+ * Map the section where the server publishes the state of all windows.
+ */
+static const volatile shared_window_t *get_shared_windows(void)
+{
+    static const volatile shared_window_t *shared_windows;
+    static BOOL failed;
+    obj_handle_t handle = 0;
+    SIZE_T size = 0;
+    void *ptr = NULL;
+
+    if (shared_windows || failed) return shared_windows;
+
+    SERVER_START_REQ( get_shared_window_section )
+    {
+        if (!wine_server_call( req ))
+        {
+            handle = reply->handle;
+            size   = reply->size;
+        }
+    }
+    SERVER_END_REQ;
+
+    if (!handle || NtMapViewOfSection( wine_server_ptr_handle( handle ), GetCurrentProcess(), &ptr,
+                                       0, 0, NULL, &size, ViewShare, 0, PAGE_READONLY ))
+    {
+        if (handle) NtClose( wine_server_ptr_handle( handle ));
+        failed = TRUE;
+        return NULL;
+    }
+    NtClose( wine_server_ptr_handle( handle ));
+
+    if (InterlockedCompareExchangePointer( (void **)&shared_windows, ptr, NULL ))
+        NtUnmapViewOfSection( GetCurrentProcess(), ptr );  /* somebody beat us to it */
+    return shared_windows;
+}
+
+
+/***********************************************************************
+ *           get_shared_window_info
+ *
+ * Retrieve the state of a window of another process without a server round trip.
+ */
+static BOOL get_shared_window_info( HWND hwnd, shared_window_t *info )
+{
+    const volatile shared_window_t *shared_windows, *entry;
+    WORD index = USER_HANDLE_TO_INDEX( hwnd );
+    unsigned int seq;
+
+    if (index >= NB_USER_HANDLES || !(shared_windows = get_shared_windows())) return FALSE;
+    entry = &shared_windows[index];
+
+    do
+    {
+        while ((seq = entry->seq) & 1) NtYieldExecution();
+        __sync_synchronize();
+        info->handle   = entry->handle;
+        info->parent   = entry->parent;
+        info->owner    = entry->owner;
+        info->style    = entry->style;
+        info->ex_style = entry->ex_style;
+        info->pid      = entry->pid;
+        info->tid      = entry->tid;
+        __sync_synchronize();
+    } while (entry->seq != seq);
+
+    if (!info->handle || LOWORD(info->handle) != LOWORD(hwnd)) return FALSE;
+    return (info->handle == HandleToUlong( hwnd ) || !HIWORD(hwnd) || HIWORD(hwnd) == 0xffff);
+}
+
+
 /***********************************************************************
  *           release_user_handle_ptr
  */
@@ -2347,11 +2420,16 @@ static LONG_PTR WIN_GetWindowLong( HWND hwnd, INT offset, UINT size, BOOL unicod
 
     if (wndPtr == WND_OTHER_PROCESS)
     {
+        shared_window_t info;
+
         if (offset == GWLP_WNDPROC)
         {
             SetLastError( ERROR_ACCESS_DENIED );
             return 0;
         }
+        if ((offset == GWL_STYLE || offset == GWL_EXSTYLE) && get_shared_window_info( hwnd, &info ))
+            return offset == GWL_STYLE ? info.style : info.ex_style;
+
         SERVER_START_REQ( set_window_info )
         {
             req->handle = wine_server_user_handle( hwnd );
@@ -2996,6 +3074,7 @@ INT WINAPI GetWindowTextLengthW( HWND hwnd )
  */
 BOOL WINAPI IsWindow( HWND hwnd )
 {
+    shared_window_t info;
     WND *ptr;
     BOOL ret;
 
@@ -3008,6 +3087,8 @@ BOOL WINAPI IsWindow( HWND hwnd )
         return TRUE;
     }
 
+    if (get_shared_window_info( hwnd, &info )) return TRUE;
+
     /* check other processes */
     SERVER_START_REQ( get_window_info )
     {
@@ -3024,6 +3105,7 @@ BOOL WINAPI IsWindow( HWND hwnd )
  */
 DWORD WINAPI GetWindowThreadProcessId( HWND hwnd, LPDWORD process )
 {
+    shared_window_t info;
     WND *ptr;
     DWORD tid = 0;
 
@@ -3042,6 +3124,12 @@ DWORD WINAPI GetWindowThreadProcessId( HWND hwnd, LPDWORD process )
         return tid;
     }
 
+    if (ptr == WND_OTHER_PROCESS && get_shared_window_info( hwnd, &info ))
+    {
+        if (process) *process = info.pid;
+        return info.tid;
+    }
+
     /* check other processes */
     SERVER_START_REQ( get_window_info )
     {
@@ -3073,7 +3161,17 @@ HWND WINAPI GetParent( HWND hwnd )
     if (wndPtr == WND_DESKTOP) return 0;
     if (wndPtr == WND_OTHER_PROCESS)
     {
-        LONG style = GetWindowLongW( hwnd, GWL_STYLE );
+        shared_window_t info;
+        LONG style;
+
+        if (get_shared_window_info( hwnd, &info ))
+        {
+            if (info.style & WS_POPUP) retvalue = wine_server_ptr_handle( info.owner );
+            else if (info.style & WS_CHILD) retvalue = wine_server_ptr_handle( info.parent );
+            return retvalue;
+        }
+
+        style = GetWindowLongW( hwnd, GWL_STYLE );
         if (style & (WS_POPUP | WS_CHILD))
         {
             SERVER_START_REQ( get_window_tree )
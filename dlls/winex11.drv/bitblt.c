@@ -1569,6 +1569,10 @@ struct x11drv_window_surface
     COLORREF              color_key;
     HRGN                  region;
     void                 *bits;
+    unsigned char        *shadow;     /* copy of the bits as last uploaded, for damage tracking */
+    RECT                  invalid;    /* area to upload at next flush even if the bits didn't change */
+    int                   skip_diff;  /* number of flushes left to do without damage tracking */
+    BOOL                  no_shadow;  /* the shadow couldn't be allocated */
 #ifdef HAVE_LIBXXSHM
     XShmSegmentInfo       shminfo;
 #endif
@@ -1576,6 +1580,13 @@ struct x11drv_window_surface
     BITMAPINFO            info;   /* variable size, must be last */
 };
 
+/* the surface bits are compared to the last uploaded ones in tiles of this size */
+#define SURFACE_TILE_SIZE 64
+/* max number of uploads for a row of tiles */
+#define SURFACE_MAX_RUNS  16
+/* number of flushes to skip damage tracking when most of the surface was dirty */
+#define SURFACE_SKIP_DIFF 16
+
 static struct x11drv_window_surface *get_x11_surface( struct window_surface *surface )
 {
     return (struct x11drv_window_surface *)surface;
@@ -1865,6 +1876,10 @@ static void x11drv_surface_set_region( struct window_surface *window_surface, HR
     TRACE( "updating surface %p with %p\n", surface, region );
 
     window_surface->funcs->lock( window_surface );
+    /* areas that were clipped out need to be uploaded again */
+    if (surface->shadow)
+        SetRect( &surface->invalid, 0, 0, window_surface->rect.right - window_surface->rect.left,
+                 window_surface->rect.bottom - window_surface->rect.top );
     if (!region)
     {
         if (surface->region) DeleteObject( surface->region );
@@ -1885,14 +1900,195 @@ static void x11drv_surface_set_region( struct window_surface *window_surface, HR
     window_surface->funcs->unlock( window_surface );
 }
 
+/***********************************************************************
+ *           copy_surface_bits
+ *
+ * Convert the surface bits to the X image format for the given rectangle.
+ * Conversion is done on full rows.
+ */
+static void copy_surface_bits( struct x11drv_window_surface *surface, const RECT *rect )
+{
+    unsigned char *src = surface->bits;
+    unsigned char *dst = (unsigned char *)surface->image->data;
+    int width_bytes = surface->image->bytes_per_line;
+
+    if (src != dst)
+    {
+        const int *mapping = NULL;
+
+        if (surface->image->bits_per_pixel == 4 || surface->image->bits_per_pixel == 8)
+            mapping = X11DRV_PALETTE_PaletteToXPixel;
+
+        src += rect->top * width_bytes;
+        dst += rect->top * width_bytes;
+        copy_image_byteswap( &surface->info, src, dst, width_bytes, width_bytes,
+                             rect->bottom - rect->top,
+                             surface->byteswap, mapping, ~0u, surface->alpha_bits );
+    }
+    else if (surface->alpha_bits)
+    {
+        int x, y, stride = surface->image->bytes_per_line / sizeof(ULONG);
+        ULONG *ptr = (ULONG *)dst + rect->top * stride;
+
+        for (y = rect->top; y < rect->bottom; y++, ptr += stride)
+            for (x = rect->left; x < rect->right; x++)
+                ptr[x] |= surface->alpha_bits;
+    }
+}
+
+/***********************************************************************
+ *           put_surface_image
+ *
+ * Upload a rectangle of the X image to the window.
+ */
+static void put_surface_image( struct x11drv_window_surface *surface, const RECT *rect )
+{
+#ifdef HAVE_LIBXXSHM
+    if (surface->shminfo.shmid != -1)
+        XShmPutImage( gdi_display, surface->window, surface->gc, surface->image,
+                      rect->left, rect->top,
+                      surface->header.rect.left + rect->left,
+                      surface->header.rect.top + rect->top,
+                      rect->right - rect->left, rect->bottom - rect->top, False );
+    else
+#endif
+    XPutImage( gdi_display, surface->window, surface->gc, surface->image,
+               rect->left, rect->top,
+               surface->header.rect.left + rect->left,
+               surface->header.rect.top + rect->top,
+               rect->right - rect->left, rect->bottom - rect->top );
+}
+
+/***********************************************************************
+ *           invalidate_surface_tiles
+ *
+ * Force the upload of a rectangle at the next flush, even if its bits didn't change.
+ * Without a shadow everything that is flushed is uploaded anyway.
+ */
+static void invalidate_surface_tiles( struct x11drv_window_surface *surface, const RECT *rect )
+{
+    if (surface->shadow) UnionRect( &surface->invalid, &surface->invalid, rect );
+}
+
+/***********************************************************************
+ *           is_tile_dirty
+ *
+ * Check whether the bits of a tile differ from the last uploaded ones.
+ */
+static BOOL is_tile_dirty( struct x11drv_window_surface *surface, const RECT *tile )
+{
+    int stride = surface->image->bytes_per_line;
+    int bpp = surface->info.bmiHeader.biBitCount;
+    int start = tile->left * bpp / 8, end = (tile->right * bpp + 7) / 8;
+    const unsigned char *bits = (const unsigned char *)surface->bits + tile->top * stride + start;
+    const unsigned char *shadow = surface->shadow + tile->top * stride + start;
+    RECT rect;
+    int y;
+
+    if (IntersectRect( &rect, tile, &surface->invalid )) return TRUE;
+
+    for (y = tile->top; y < tile->bottom; y++, bits += stride, shadow += stride)
+        if (memcmp( bits, shadow, end - start )) return TRUE;
+    return FALSE;
+}
+
+/***********************************************************************
+ *           update_surface_shadow
+ */
+static void update_surface_shadow( struct x11drv_window_surface *surface, const RECT *rect )
+{
+    int stride = surface->image->bytes_per_line;
+    int bpp = surface->info.bmiHeader.biBitCount;
+    int start = rect->left * bpp / 8, end = (rect->right * bpp + 7) / 8;
+    const unsigned char *bits = (const unsigned char *)surface->bits + rect->top * stride + start;
+    unsigned char *shadow = surface->shadow + rect->top * stride + start;
+    int y;
+
+    for (y = rect->top; y < rect->bottom; y++, bits += stride, shadow += stride)
+        memcpy( shadow, bits, end - start );
+}
+
+/***********************************************************************
+ *           flush_tile_runs
+ *
+ * Upload runs of dirty tiles from the same row of tiles. The rows only need
+ * to be converted once when the image has its own copy of the bits.
+ */
+static unsigned int flush_tile_runs( struct x11drv_window_surface *surface, const RECT *runs,
+                                     unsigned int count, BOOL *converted )
+{
+    int bpp = surface->image->bits_per_pixel;
+    unsigned int i, bytes = 0;
+
+    for (i = 0; i < count; i++)
+    {
+        if (!*converted) copy_surface_bits( surface, &runs[i] );
+        *converted = (surface->bits != surface->image->data);
+        update_surface_shadow( surface, &runs[i] );
+        put_surface_image( surface, &runs[i] );
+        bytes += ((runs[i].right - runs[i].left) * bpp + 7) / 8 * (runs[i].bottom - runs[i].top);
+    }
+    return bytes;
+}
+
+/***********************************************************************
+ *           flush_dirty_tiles
+ *
+ * Upload only the tiles of the rectangle whose bits changed since the last
+ * flush. Adjacent dirty tiles in a row are merged into a single image upload.
+ */
+static void flush_dirty_tiles( struct x11drv_window_surface *surface, const RECT *visrect )
+{
+    RECT runs[SURFACE_MAX_RUNS], tile;
+    unsigned int count, tiles = 0, dirty = 0, bytes = 0;
+    BOOL converted;
+    int x, y;
+
+    for (y = visrect->top & ~(SURFACE_TILE_SIZE - 1); y < visrect->bottom; y += SURFACE_TILE_SIZE)
+    {
+        tile.top    = max( y, visrect->top );
+        tile.bottom = min( y + SURFACE_TILE_SIZE, visrect->bottom );
+        count = 0;
+        converted = FALSE;
+
+        for (x = visrect->left & ~(SURFACE_TILE_SIZE - 1); x < visrect->right; x += SURFACE_TILE_SIZE)
+        {
+            tile.left  = max( x, visrect->left );
+            tile.right = min( x + SURFACE_TILE_SIZE, visrect->right );
+            tiles++;
+            if (!is_tile_dirty( surface, &tile )) continue;
+            dirty++;
+            if (count && runs[count - 1].right == tile.left)
+            {
+                runs[count - 1].right = tile.right;
+                continue;
+            }
+            if (count == SURFACE_MAX_RUNS)
+            {
+                bytes += flush_tile_runs( surface, runs, count, &converted );
+                count = 0;
+            }
+            runs[count++] = tile;
+        }
+        bytes += flush_tile_runs( surface, runs, count, &converted );
+    }
+
+    TRACE( "surface %p: %u/%u dirty tiles in %s, %u bytes uploaded\n",
+           surface, dirty, tiles, wine_dbgstr_rect( visrect ), bytes );
+
+    /* the flushed area always covers the invalid one, see x11drv_surface_flush */
+    SetRectEmpty( &surface->invalid );
+
+    /* most of the surface changes at every flush, comparing is a waste of time */
+    if (dirty * 4 >= tiles * 3) surface->skip_diff = SURFACE_SKIP_DIFF;
+}
+
 /***********************************************************************
  *           x11drv_surface_flush
  */
 static void x11drv_surface_flush( struct window_surface *window_surface )
 {
     struct x11drv_window_surface *surface = get_x11_surface( window_surface );
-    unsigned char *src = surface->bits;
-    unsigned char *dst = (unsigned char *)surface->image->data;
     struct bitblt_coords coords;
 
     window_surface->funcs->lock( window_surface );
@@ -1901,6 +2097,17 @@ static void x11drv_surface_flush( struct window_surface *window_surface )
     coords.width  = surface->header.rect.right - surface->header.rect.left;
     coords.height = surface->header.rect.bottom - surface->header.rect.top;
     SetRect( &coords.visrect, 0, 0, coords.width, coords.height );
+    if (!surface->skip_diff && !surface->shadow && !surface->no_shadow)
+    {
+        /* the shadow starts out invalid, the first flush uploads everything */
+        surface->shadow = HeapAlloc( GetProcessHeap(), 0, surface->image->bytes_per_line * coords.height );
+        surface->no_shadow = !surface->shadow;
+        if (surface->shadow) surface->invalid = coords.visrect;
+    }
+    /* make sure that areas which have to be uploaded again get flushed */
+    if (!surface->skip_diff && surface->shadow &&
+        IntersectRect( &surface->invalid, &surface->invalid, &coords.visrect ))
+        add_bounds_rect( &surface->bounds, &surface->invalid );
     if (IntersectRect( &coords.visrect, &coords.visrect, &surface->bounds ))
     {
         TRACE( "flushing %p %dx%d bounds %s bits %p\n",
@@ -1909,46 +2116,16 @@ static void x11drv_surface_flush( struct window_surface *window_surface )
 
         if (surface->is_argb || surface->color_key != CLR_INVALID) update_surface_region( surface );
 
-        if (src != dst)
-        {
-            const int *mapping = NULL;
-            int width_bytes = surface->image->bytes_per_line;
-
-            if (surface->image->bits_per_pixel == 4 || surface->image->bits_per_pixel == 8)
-                mapping = X11DRV_PALETTE_PaletteToXPixel;
-
-            src += coords.visrect.top * width_bytes;
-            dst += coords.visrect.top * width_bytes;
-            copy_image_byteswap( &surface->info, src, dst, width_bytes, width_bytes,
-                                 coords.visrect.bottom - coords.visrect.top,
-                                 surface->byteswap, mapping, ~0u, surface->alpha_bits );
-        }
-        else if (surface->alpha_bits)
+        if (!surface->skip_diff && surface->shadow)
+            flush_dirty_tiles( surface, &coords.visrect );
+        else
         {
-            int x, y, stride = surface->image->bytes_per_line / sizeof(ULONG);
-            ULONG *ptr = (ULONG *)dst + coords.visrect.top * stride;
-
-            for (y = coords.visrect.top; y < coords.visrect.bottom; y++, ptr += stride)
-                for (x = coords.visrect.left; x < coords.visrect.right; x++)
-                    ptr[x] |= surface->alpha_bits;
+            /* the shadow is out of date for what we upload now */
+            if (surface->skip_diff) surface->skip_diff--;
+            invalidate_surface_tiles( surface, &coords.visrect );
+            copy_surface_bits( surface, &coords.visrect );
+            put_surface_image( surface, &coords.visrect );
         }
-
-#ifdef HAVE_LIBXXSHM
-        if (surface->shminfo.shmid != -1)
-            XShmPutImage( gdi_display, surface->window, surface->gc, surface->image,
-                          coords.visrect.left, coords.visrect.top,
-                          surface->header.rect.left + coords.visrect.left,
-                          surface->header.rect.top + coords.visrect.top,
-                          coords.visrect.right - coords.visrect.left,
-                          coords.visrect.bottom - coords.visrect.top, False );
-        else
-#endif
-        XPutImage( gdi_display, surface->window, surface->gc, surface->image,
-                   coords.visrect.left, coords.visrect.top,
-                   surface->header.rect.left + coords.visrect.left,
-                   surface->header.rect.top + coords.visrect.top,
-                   coords.visrect.right - coords.visrect.left,
-                   coords.visrect.bottom - coords.visrect.top );
         XFlush( gdi_display );
     }
     reset_bounds( &surface->bounds );
@@ -1979,6 +2156,7 @@ static void x11drv_surface_destroy( struct window_surface *window_surface )
         surface->image->data = NULL;
         XDestroyImage( surface->image );
     }
+    HeapFree( GetProcessHeap(), 0, surface->shadow );
     surface->crit.DebugInfo->Spare[0] = 0;
     DeleteCriticalSection( &surface->crit );
     if (surface->region) DeleteObject( surface->region );
@@ -2099,6 +2277,7 @@ HRGN expose_surface( struct window_surface *window_surface, const RECT *rect )
     window_surface->funcs->lock( window_surface );
     OffsetRect( &rc, -window_surface->rect.left, -window_surface->rect.top );
     add_bounds_rect( &surface->bounds, &rc );
+    invalidate_surface_tiles( surface, &rc );
     if (surface->region)
     {
         region = CreateRectRgnIndirect( rect );
@@ -252,6 +252,19 @@ typedef struct
 } rectangle_t;
 
 
+typedef struct
+{
+    unsigned int   seq;
+    user_handle_t  handle;
+    user_handle_t  parent;
+    user_handle_t  owner;
+    unsigned int   style;
+    unsigned int   ex_style;
+    process_id_t   pid;
+    thread_id_t    tid;
+} shared_window_t;
+
+
 typedef struct
 {
     obj_handle_t    handle;
@@ -724,6 +737,15 @@ struct rawinput_device
     user_handle_t  target;
 };
 
+struct completion_entry
+{
+    apc_param_t    ckey;
+    apc_param_t    cvalue;
+    apc_param_t    information;
+    unsigned int   status;
+    int            __pad;
+};
+
 
 
 
@@ -3019,6 +3041,23 @@ struct get_msg_queue_reply
 
 
 
+
+
+struct get_msg_queue_status_section_request
+{
+    struct request_header __header;
+    char __pad_12[4];
+};
+struct get_msg_queue_status_section_reply
+{
+    struct reply_header __header;
+    obj_handle_t handle;
+    char __pad_12[4];
+    mem_size_t   size;
+};
+
+
+
 struct set_queue_fd_request
 {
     struct request_header __header;
@@ -3541,6 +3580,21 @@ struct get_window_info_reply
 
 
 
+struct get_shared_window_section_request
+{
+    struct request_header __header;
+    char __pad_12[4];
+};
+struct get_shared_window_section_reply
+{
+    struct reply_header __header;
+    obj_handle_t   handle;
+    char __pad_12[4];
+    mem_size_t     size;
+};
+
+
+
 struct set_window_info_request
 {
     struct request_header __header;
@@ -5345,6 +5399,19 @@ struct remove_completion_reply
 
 
 
+struct remove_completions_request
+{
+    struct request_header __header;
+    obj_handle_t  handle;
+};
+struct remove_completions_reply
+{
+    struct reply_header __header;
+    /* VARARG(entries,completion_entries); */
+};
+
+
+
 struct query_completion_request
 {
     struct request_header __header;
@@ -5801,6 +5868,7 @@ enum request
     REQ_empty_atom_table,
     REQ_init_atom_table,
     REQ_get_msg_queue,
+    REQ_get_msg_queue_status_section,
     REQ_set_queue_fd,
     REQ_set_queue_mask,
     REQ_get_queue_status,
@@ -5831,6 +5899,7 @@ enum request
     REQ_get_desktop_window,
     REQ_set_window_owner,
     REQ_get_window_info,
+    REQ_get_shared_window_section,
     REQ_set_window_info,
     REQ_set_parent,
     REQ_get_window_parents,
@@ -5937,6 +6006,7 @@ enum request
     REQ_open_completion,
     REQ_add_completion,
     REQ_remove_completion,
+    REQ_remove_completions,
     REQ_query_completion,
     REQ_set_completion_info,
     REQ_add_fd_completion,
@@ -6099,6 +6169,7 @@ union generic_request
     struct empty_atom_table_request empty_atom_table_request;
     struct init_atom_table_request init_atom_table_request;
     struct get_msg_queue_request get_msg_queue_request;
+    struct get_msg_queue_status_section_request get_msg_queue_status_section_request;
     struct set_queue_fd_request set_queue_fd_request;
     struct set_queue_mask_request set_queue_mask_request;
     struct get_queue_status_request get_queue_status_request;
@@ -6129,6 +6200,7 @@ union generic_request
     struct get_desktop_window_request get_desktop_window_request;
     struct set_window_owner_request set_window_owner_request;
     struct get_window_info_request get_window_info_request;
+    struct get_shared_window_section_request get_shared_window_section_request;
     struct set_window_info_request set_window_info_request;
     struct set_parent_request set_parent_request;
     struct get_window_parents_request get_window_parents_request;
@@ -6235,6 +6307,7 @@ union generic_request
     struct open_completion_request open_completion_request;
     struct add_completion_request add_completion_request;
     struct remove_completion_request remove_completion_request;
+    struct remove_completions_request remove_completions_request;
     struct query_completion_request query_completion_request;
     struct set_completion_info_request set_completion_info_request;
     struct add_fd_completion_request add_fd_completion_request;
@@ -6395,6 +6468,7 @@ union generic_reply
     struct empty_atom_table_reply empty_atom_table_reply;
     struct init_atom_table_reply init_atom_table_reply;
     struct get_msg_queue_reply get_msg_queue_reply;
+    struct get_msg_queue_status_section_reply get_msg_queue_status_section_reply;
     struct set_queue_fd_reply set_queue_fd_reply;
     struct set_queue_mask_reply set_queue_mask_reply;
     struct get_queue_status_reply get_queue_status_reply;
@@ -6425,6 +6499,7 @@ union generic_reply
     struct get_desktop_window_reply get_desktop_window_reply;
     struct set_window_owner_reply set_window_owner_reply;
     struct get_window_info_reply get_window_info_reply;
+    struct get_shared_window_section_reply get_shared_window_section_reply;
     struct set_window_info_reply set_window_info_reply;
     struct set_parent_reply set_parent_reply;
     struct get_window_parents_reply get_window_parents_reply;
@@ -6531,6 +6606,7 @@ union generic_reply
     struct open_completion_reply open_completion_reply;
     struct add_completion_reply add_completion_reply;
     struct remove_completion_reply remove_completion_reply;
+    struct remove_completions_reply remove_completions_reply;
     struct query_completion_reply query_completion_reply;
     struct set_completion_info_reply set_completion_info_reply;
     struct add_fd_completion_reply add_fd_completion_reply;
@@ -6554,6 +6630,6 @@ union generic_reply
     struct terminate_job_reply terminate_job_reply;
 };
 
-#define SERVER_PROTOCOL_VERSION 572
+#define SERVER_PROTOCOL_VERSION 575
 
 #endif /* __WINE_WINE_SERVER_PROTOCOL_H */
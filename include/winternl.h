@@ -1275,6 +1275,22 @@ typedef struct _RTL_HEAP_DEFINITION {
     ULONG Unknown[11];
 } RTL_HEAP_DEFINITION, *PRTL_HEAP_DEFINITION;
 
+/* Wine specific heap information class for RtlQueryHeapInformation */
+#define HeapWineStatistics ((HEAP_INFORMATION_CLASS)0x1000)
+
+typedef struct _HEAP_WINE_STATISTICS {
+    SIZE_T ReservedSize;
+    SIZE_T CommittedSize;
+    SIZE_T InUseSize;
+    SIZE_T FreeSize;
+    SIZE_T FreeBlocks;
+    SIZE_T CachedBlocks;
+    SIZE_T LargeBlocks;
+    SIZE_T LargeSize;
+    SIZE_T AllocCount;
+    SIZE_T FreeCount;
+} HEAP_WINE_STATISTICS, *PHEAP_WINE_STATISTICS;
+
 typedef struct _RTL_RWLOCK {
     RTL_CRITICAL_SECTION rtlCS;
 
@@ -2585,6 +2601,7 @@ NTSYSAPI BOOLEAN   WINAPI RtlAreAllAccessesGranted(ACCESS_MASK,ACCESS_MASK);
 NTSYSAPI BOOLEAN   WINAPI RtlAreAnyAccessesGranted(ACCESS_MASK,ACCESS_MASK);
 NTSYSAPI BOOLEAN   WINAPI RtlAreBitsSet(PCRTL_BITMAP,ULONG,ULONG);
 NTSYSAPI BOOLEAN   WINAPI RtlAreBitsClear(PCRTL_BITMAP,ULONG,ULONG);
+NTSYSAPI USHORT    WINAPI RtlCaptureStackBackTrace(ULONG,ULONG,PVOID*,ULONG*);
 NTSYSAPI NTSTATUS  WINAPI RtlCharToInteger(PCSZ,ULONG,PULONG);
 NTSYSAPI NTSTATUS  WINAPI RtlCheckRegistryKey(ULONG, PWSTR);
 NTSYSAPI void      WINAPI RtlClearAllBits(PRTL_BITMAP);
@@ -359,13 +359,17 @@ static file_pos_t max_unix_offset = OFF_T_MAX;
 
 struct timeout_user
 {
-    struct list           entry;      /* entry in sorted timeout list */
+    struct list           entry;      /* entry in expired list, while running the callbacks */
+    int                   index;      /* index in the timeout heap, -1 once expired */
     timeout_t             when;       /* timeout expiry (absolute time) */
     timeout_callback      callback;   /* callback function */
     void                 *private;    /* callback private data */
 };
 
-static struct list timeout_list = LIST_INIT(timeout_list);   /* sorted timeouts list */
+static struct timeout_user **timeout_heap;   /* binary min-heap of timeouts, ordered by expiry */
+static int timeout_count;                    /* number of timeouts in the heap */
+static int timeout_size;                     /* allocated size of the heap array */
+static struct list expired_list = LIST_INIT(expired_list);  /* expired timeouts pending their callback */
 timeout_t current_time;
 
 static inline void set_current_time(void)
@@ -376,32 +380,90 @@ static inline void set_current_time(void)
     current_time = (timeout_t)now.tv_sec * TICKS_PER_SEC + now.tv_usec * 10 + ticks_1601_to_1970;
 }
 
+static inline void set_timeout_heap_entry( int index, struct timeout_user *user )
+{
+    timeout_heap[index] = user;
+    user->index = index;
+}
+
+/* move a timeout towards the top of the heap until its parent expires earlier */
+static void timeout_heap_sift_up( int index, struct timeout_user *user )
+{
+    while (index > 0)
+    {
+        int parent = (index - 1) / 2;
+        if (timeout_heap[parent]->when <= user->when) break;
+        set_timeout_heap_entry( index, timeout_heap[parent] );
+        index = parent;
+    }
+    set_timeout_heap_entry( index, user );
+}
+
+/* move a timeout towards the bottom of the heap until its children expire later */
+static void timeout_heap_sift_down( int index, struct timeout_user *user )
+{
+    for (;;)
+    {
+        int child = 2 * index + 1;
+        if (child >= timeout_count) break;
+        if (child + 1 < timeout_count && timeout_heap[child + 1]->when < timeout_heap[child]->when)
+            child++;
+        if (user->when <= timeout_heap[child]->when) break;
+        set_timeout_heap_entry( index, timeout_heap[child] );
+        index = child;
+    }
+    set_timeout_heap_entry( index, user );
+}
+
+/* remove an entry from the timeout heap */
+static void timeout_heap_remove( struct timeout_user *user )
+{
+    int index = user->index;
+    struct timeout_user *last = timeout_heap[--timeout_count];
+
+    user->index = -1;
+    if (last == user) return;
+    if (index > 0 && last->when < timeout_heap[(index - 1) / 2]->when)
+        timeout_heap_sift_up( index, last );
+    else
+        timeout_heap_sift_down( index, last );
+}
+
 /* add a timeout user */
 struct timeout_user *add_timeout_user( timeout_t when, timeout_callback func, void *private )
 {
     struct timeout_user *user;
-    struct list *ptr;
+
+    if (timeout_count == timeout_size)
+    {
+        int new_size = timeout_size ? timeout_size * 2 : 64;
+        struct timeout_user **new_heap;
+
+        if (!(new_heap = realloc( timeout_heap, new_size * sizeof(*new_heap) )))
+        {
+            set_error( STATUS_NO_MEMORY );
+            return NULL;
+        }
+        timeout_heap = new_heap;
+        timeout_size = new_size;
+    }
 
     if (!(user = mem_alloc( sizeof(*user) ))) return NULL;
     user->when     = (when > 0) ? when : current_time - when;
     user->callback = func;
     user->private  = private;
 
-    /* Now insert it in the linked list */
-
-    LIST_FOR_EACH( ptr, &timeout_list )
-    {
-        struct timeout_user *timeout = LIST_ENTRY( ptr, struct timeout_user, entry );
-        if (timeout->when >= user->when) break;
-    }
-    list_add_before( ptr, &user->entry );
+    timeout_heap_sift_up( timeout_count++, user );
     return user;
 }
 
 /* remove a timeout user */
 void remove_timeout_user( struct timeout_user *user )
 {
-    list_remove( &user->entry );
+    if (user->index == -1)
+        list_remove( &user->entry );  /* already expired, but callback not called yet */
+    else
+        timeout_heap_remove( user );
     free( user );
 }
 
@@ -847,44 +909,33 @@ static void remove_poll_user( struct fd *fd, int user )
 /* process pending timeouts and return the time until the next timeout, in milliseconds */
 static int get_next_timeout(void)
 {
-    if (!list_empty( &timeout_list ))
-    {
-        struct list expired_list, *ptr;
+    struct list *ptr;
+    int diff;
 
-        /* first remove all expired timers from the list */
+    /* first remove all expired timers from the heap */
 
-        list_init( &expired_list );
-        while ((ptr = list_head( &timeout_list )) != NULL)
-        {
-            struct timeout_user *timeout = LIST_ENTRY( ptr, struct timeout_user, entry );
+    while (timeout_count && timeout_heap[0]->when <= current_time)
+    {
+        struct timeout_user *timeout = timeout_heap[0];
+        timeout_heap_remove( timeout );
+        list_add_tail( &expired_list, &timeout->entry );
+    }
 
-            if (timeout->when <= current_time)
-            {
-                list_remove( &timeout->entry );
-                list_add_tail( &expired_list, &timeout->entry );
-            }
-            else break;
-        }
+    /* now call the callback for all the removed timers */
 
-        /* now call the callback for all the removed timers */
+    while ((ptr = list_head( &expired_list )) != NULL)
+    {
+        struct timeout_user *timeout = LIST_ENTRY( ptr, struct timeout_user, entry );
+        list_remove( &timeout->entry );
+        timeout->callback( timeout->private );
+        free( timeout );
+    }
 
-        while ((ptr = list_head( &expired_list )) != NULL)
-        {
-            struct timeout_user *timeout = LIST_ENTRY( ptr, struct timeout_user, entry );
-            list_remove( &timeout->entry );
-            timeout->callback( timeout->private );
-            free( timeout );
-        }
+    if (!timeout_count) return -1;  /* no pending timeouts */
 
-        if ((ptr = list_head( &timeout_list )) != NULL)
-        {
-            struct timeout_user *timeout = LIST_ENTRY( ptr, struct timeout_user, entry );
-            int diff = (timeout->when - current_time + 9999) / 10000;
-            if (diff < 0) diff = 0;
-            return diff;
-        }
-    }
-    return -1;  /* no pending timeouts */
+    diff = (timeout_heap[0]->when - current_time + 9999) / 10000;
+    if (diff < 0) diff = 0;
+    return diff;
 }
 
 /* server main poll() loop */
@@ -158,6 +158,8 @@ extern struct file *get_mapping_file( struct process *process, client_ptr_t base
                                       unsigned int access, unsigned int sharing );
 extern void free_mapped_views( struct process *process );
 extern int get_page_size(void);
+extern struct mapping *create_shared_mapping( mem_size_t size, void **ptr );
+extern void free_shared_mapping( struct mapping *mapping, void *ptr );
 
 /* device functions */
 
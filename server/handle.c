@@ -42,7 +42,7 @@
 struct handle_entry
 {
     struct object *ptr;       /* object */
-    unsigned int   access;    /* access rights */
+    unsigned int   access;    /* access rights, or index of the next free entry if ptr is NULL */
 };
 
 struct handle_table
@@ -50,8 +50,9 @@ struct handle_table
     struct object        obj;         /* object header */
     struct process      *process;     /* process owning this table */
     int                  count;       /* number of allocated entries */
-    int                  last;        /* last used entry */
-    int                  free;        /* first entry that may be free */
+    int                  last;        /* last entry that may be in use */
+    int                  used;        /* number of used entries */
+    int                  free;        /* head of the list of free entries up to last, or -1 */
     struct handle_entry *entries;     /* handle entries */
 };
 
@@ -208,7 +209,8 @@ struct handle_table *alloc_handle_table( struct process *process, int count )
     table->process = process;
     table->count   = count;
     table->last    = -1;
-    table->free    = 0;
+    table->used    = 0;
+    table->free    = -1;
     if ((table->entries = mem_alloc( count * sizeof(*table->entries) ))) return table;
     release_object( table );
     return NULL;
@@ -231,21 +233,44 @@ static int grow_handle_table( struct handle_table *table )
     return 1;
 }
 
-/* allocate the first free entry in the handle table */
+/* add an unused entry to the free list */
+static inline void free_entry( struct handle_table *table, int index )
+{
+    table->entries[index].ptr    = NULL;
+    table->entries[index].access = table->free;
+    table->free = index;
+}
+
+/* rebuild the free list so that the lowest entries get reused first */
+static void build_free_list( struct handle_table *table )
+{
+    int i;
+
+    table->free = -1;
+    for (i = table->last; i >= 0; i--)
+        if (!table->entries[i].ptr) free_entry( table, i );
+}
+
+/* allocate a free entry in the handle table, reusing the most recently freed one */
 static obj_handle_t alloc_entry( struct handle_table *table, void *obj, unsigned int access )
 {
-    struct handle_entry *entry = table->entries + table->free;
+    struct handle_entry *entry;
     int i;
 
-    for (i = table->free; i <= table->last; i++, entry++) if (!entry->ptr) goto found;
-    if (i >= table->count)
+    if ((i = table->free) != -1)
     {
-        if (!grow_handle_table( table )) return 0;
-        entry = table->entries + i;  /* the entries may have moved */
+        entry = table->entries + i;
+        assert( !entry->ptr );
+        table->free = entry->access;
     }
-    table->last = i;
- found:
-    table->free = i + 1;
+    else
+    {
+        i = table->last + 1;
+        if (i >= table->count && !grow_handle_table( table )) return 0;
+        entry = table->entries + i;
+        table->last = i;
+    }
+    table->used++;
     entry->ptr    = grab_object_for_handle( obj );
     entry->access = access;
     return index_to_handle(i);
@@ -332,11 +357,15 @@ static struct handle_entry *get_handle( struct process *process, obj_handle_t ha
 }
 
 /* attempt to shrink a table */
+/* the free list is rebuilt when entries are trimmed, so this is only done */
+/* when the table is mostly unused to keep allocations amortized O(1) */
 static void shrink_handle_table( struct handle_table *table )
 {
     struct handle_entry *entry = table->entries + table->last;
     struct handle_entry *new_entries;
-    int count = table->count;
+    int last = table->last, count = table->count;
+
+    if (table->used >= count / 4) return;  /* no need to shrink */
 
     while (table->last >= 0)
     {
@@ -344,6 +373,8 @@ static void shrink_handle_table( struct handle_table *table )
         table->last--;
         entry--;
     }
+    if (table->last != last) build_free_list( table );
+
     if (table->last >= count / 4) return;  /* no need to shrink */
     if (count < MIN_HANDLE_ENTRIES * 2) return;  /* too small to shrink */
     count /= 2;
@@ -373,9 +404,14 @@ struct handle_table *copy_handle_table( struct process *process, struct process
         for (i = 0; i <= table->last; i++, ptr++)
         {
             if (!ptr->ptr) continue;
-            if (ptr->access & RESERVED_INHERIT) grab_object_for_handle( ptr->ptr );
+            if (ptr->access & RESERVED_INHERIT)
+            {
+                grab_object_for_handle( ptr->ptr );
+                table->used++;
+            }
             else ptr->ptr = NULL; /* don't inherit this entry */
         }
+        build_free_list( table );
     }
     /* attempt to shrink the table */
     shrink_handle_table( table );
@@ -393,9 +429,9 @@ unsigned int close_handle( struct process *process, obj_handle_t handle )
     if (entry->access & RESERVED_CLOSE_PROTECT) return STATUS_HANDLE_NOT_CLOSABLE;
     obj = entry->ptr;
     if (!obj->ops->close_handle( obj, process, handle )) return STATUS_HANDLE_NOT_CLOSABLE;
-    entry->ptr = NULL;
     table = handle_is_global(handle) ? global_table : process->handles;
-    if (entry < table->entries + table->free) table->free = entry - table->entries;
+    free_entry( table, entry - table->entries );
+    table->used--;
     if (entry == table->entries + table->last) shrink_handle_table( table );
     release_object_from_handle( obj );
     return STATUS_SUCCESS;
@@ -936,6 +936,36 @@ int get_page_size(void)
     return page_mask + 1;
 }
 
+/* create an anonymous mapping that is also mapped writable in the server */
+struct mapping *create_shared_mapping( mem_size_t size, void **ptr )
+{
+    struct mapping *mapping;
+    void *base;
+    int unix_fd;
+
+    if (!(mapping = (struct mapping *)create_mapping( NULL, NULL, 0, size, SEC_COMMIT, 0, 0, NULL )))
+        return NULL;
+    if ((unix_fd = get_unix_fd( mapping->fd )) == -1) goto error;
+    if ((base = mmap( NULL, mapping->size, PROT_READ | PROT_WRITE, MAP_SHARED, unix_fd, 0 )) == MAP_FAILED)
+    {
+        file_set_error();
+        goto error;
+    }
+    *ptr = base;
+    return mapping;
+
+ error:
+    release_object( mapping );
+    return NULL;
+}
+
+/* release a mapping created with create_shared_mapping */
+void free_shared_mapping( struct mapping *mapping, void *ptr )
+{
+    munmap( ptr, mapping->size );
+    release_object( mapping );
+}
+
 /* create a file mapping */
 DECL_HANDLER(create_mapping)
 {
@@ -140,6 +140,8 @@ struct msg_queue
     struct thread_input   *input;           /* thread input descriptor */
     struct hook_table     *hooks;           /* hook table */
     timeout_t              last_get_msg;    /* time of last get message call */
+    struct mapping        *shared_mapping;  /* section shared with the client */
+    unsigned int          *shared_status;   /* queue bits published in the shared section */
 };
 
 struct hotkey
@@ -298,6 +300,8 @@ static struct msg_queue *create_msg_queue( struct thread *thread, struct thread_
         queue->input           = (struct thread_input *)grab_object( input );
         queue->hooks           = NULL;
         queue->last_get_msg    = current_time;
+        queue->shared_mapping  = NULL;
+        queue->shared_status   = NULL;
         list_init( &queue->send_result );
         list_init( &queue->callback_result );
         list_init( &queue->pending_timers );
@@ -440,6 +444,12 @@ void set_queue_hooks( struct thread *thread, struct hook_table *hooks )
     queue->hooks = hooks;
 }
 
+/* publish the queue bits in the shared section, in the GetQueueStatus layout */
+static inline void update_shared_status( struct msg_queue *queue )
+{
+    if (queue->shared_status) *queue->shared_status = MAKELONG( queue->changed_bits, queue->wake_bits );
+}
+
 /* check the queue status */
 static inline int is_signaled( struct msg_queue *queue )
 {
@@ -451,6 +461,7 @@ static inline void set_queue_bits( struct msg_queue *queue, unsigned int bits )
 {
     queue->wake_bits |= bits;
     queue->changed_bits |= bits;
+    update_shared_status( queue );
     if (is_signaled( queue )) wake_up( &queue->obj, 0 );
 }
 
@@ -459,6 +470,7 @@ static inline void clear_queue_bits( struct msg_queue *queue, unsigned int bits
 {
     queue->wake_bits &= ~bits;
     queue->changed_bits &= ~bits;
+    update_shared_status( queue );
 }
 
 /* check whether msg is a keyboard message */
@@ -1006,6 +1018,7 @@ static void msg_queue_destroy( struct object *obj )
     release_object( queue->input );
     if (queue->hooks) release_object( queue->hooks );
     if (queue->fd) release_object( queue->fd );
+    if (queue->shared_mapping) free_shared_mapping( queue->shared_mapping, queue->shared_status );
 }
 
 static void msg_queue_poll_event( struct fd *fd, int event )
@@ -2181,6 +2194,25 @@ DECL_HANDLER(get_msg_queue)
 }
 
 
+/* get a handle to the section where the current thread queue status is published */
+DECL_HANDLER(get_msg_queue_status_section)
+{
+    struct msg_queue *queue = get_current_queue();
+
+    if (!queue) return;
+    if (!queue->shared_mapping)
+    {
+        if (!(queue->shared_mapping = create_shared_mapping( get_page_size(),
+                                                             (void **)&queue->shared_status )))
+            return;
+        update_shared_status( queue );
+    }
+    reply->handle = alloc_handle( current->process, queue->shared_mapping,
+                                  SECTION_QUERY | SECTION_MAP_READ | SECTION_MAP_WRITE, 0 );
+    reply->size   = get_page_size();
+}
+
+
 /* set the file descriptor associated to the current thread queue */
 DECL_HANDLER(set_queue_fd)
 {
@@ -2236,6 +2268,7 @@ DECL_HANDLER(get_queue_status)
         reply->wake_bits    = queue->wake_bits;
         reply->changed_bits = queue->changed_bits;
         queue->changed_bits &= ~req->clear_bits;
+        update_shared_status( queue );
     }
     else reply->wake_bits = reply->changed_bits = 0;
 }
@@ -2412,6 +2445,7 @@ DECL_HANDLER(get_message)
     }
     if (filter & QS_INPUT) queue->changed_bits &= ~QS_INPUT;
     if (filter & QS_PAINT) queue->changed_bits &= ~QS_PAINT;
+    update_shared_status( queue );
 
     /* then check for posted messages */
     if ((filter & QS_POSTMESSAGE) &&
@@ -72,6 +72,9 @@ struct key
     int               last_subkey; /* last in use subkey */
     int               nb_subkeys;  /* count of allocated subkeys */
     struct key      **subkeys;     /* subkeys array */
+    struct key      **subkey_hash; /* hash table of subkeys, for keys with many subkeys */
+    unsigned int      hash_size;   /* number of buckets in the hash table */
+    struct key       *hash_next;   /* next key in the same bucket of the parent hash table */
     int               last_value;  /* last in use value */
     int               nb_values;   /* count of allocated values in array */
     struct key_value *values;      /* values array */
@@ -87,6 +90,7 @@ struct key
 #define KEY_SYMLINK  0x0008  /* key is a symbolic link */
 #define KEY_WOW64    0x0010  /* key contains a Wow6432Node subkey */
 #define KEY_WOWSHARE 0x0020  /* key is a Wow64 shared key (used for Software\Classes) */
+#define KEY_UNSORTED 0x0040  /* subkeys array needs to be sorted before index-based access */
 
 /* a key value */
 struct key_value
@@ -99,6 +103,7 @@ struct key_value
 };
 
 #define MIN_SUBKEYS  8   /* min. number of allocated subkeys per key */
+#define MIN_HASHED_SUBKEYS 64  /* number of subkeys above which a hash table is used */
 #define MIN_VALUES   8   /* min. number of allocated values per key */
 
 #define MAX_NAME_LEN  256    /* max. length of a key name */
@@ -110,6 +115,7 @@ static struct key *root_key;
 static const timeout_t ticks_1601_to_1970 = (timeout_t)86400 * (369 * 365 + 89) * TICKS_PER_SEC;
 static const timeout_t save_period = 30 * -TICKS_PER_SEC;  /* delay between periodic saves */
 static struct timeout_user *save_timeout_user;  /* saving timer */
+static const size_t file_buffer_size = 65536;    /* stdio buffer size for loading and saving files */
 static enum prefix_type { PREFIX_UNKNOWN, PREFIX_32BIT, PREFIX_64BIT } prefix_type;
 
 static const WCHAR root_name[] = { '\\','R','e','g','i','s','t','r','y','\\' };
@@ -204,6 +210,8 @@ static void dump_path( const struct key *key, const struct key *base, FILE *f )
 /* dump a value to a text file */
 static void dump_value( const struct key_value *value, FILE *f )
 {
+    static const char hex[] = "0123456789abcdef";
+    char buffer[256], *pos = buffer;
     unsigned int i, dw;
     int count;
 
@@ -241,26 +249,65 @@ static void dump_value( const struct key_value *value, FILE *f )
     else count += fprintf( f, "hex(%x):", value->type );
     for (i = 0; i < value->len; i++)
     {
-        count += fprintf( f, "%02x", *((unsigned char *)value->data + i) );
+        unsigned char byte = *((unsigned char *)value->data + i);
+
+        /* format into a local buffer, fprintf per byte is too slow for large values */
+        if (pos > buffer + sizeof(buffer) - 8)
+        {
+            fwrite( buffer, pos - buffer, 1, f );
+            pos = buffer;
+        }
+        *pos++ = hex[byte >> 4];
+        *pos++ = hex[byte & 0x0f];
+        count += 2;
         if (i < value->len-1)
         {
-            fputc( ',', f );
+            *pos++ = ',';
             if (++count > 76)
             {
-                fprintf( f, "\\\n  " );
+                memcpy( pos, "\\\n  ", 4 );
+                pos += 4;
                 count = 2;
             }
         }
     }
-    fputc( '\n', f );
+    *pos++ = '\n';
+    fwrite( buffer, pos - buffer, 1, f );
+}
+
+/* compare the name of a subkey with a given name */
+static inline int compare_subkey_name( const struct key *key, const WCHAR *name, data_size_t namelen )
+{
+    data_size_t len = min( key->namelen, namelen );
+    int res = memicmpW( key->name, name, len / sizeof(WCHAR) );
+
+    if (!res) res = key->namelen - namelen;
+    return res;
+}
+
+static int subkey_compare( const void *p1, const void *p2 )
+{
+    const struct key *key1 = *(const struct key * const *)p1;
+    const struct key *key2 = *(const struct key * const *)p2;
+
+    return compare_subkey_name( key1, key2->name, key2->namelen );
+}
+
+/* restore the sort order of the subkeys array */
+static void sort_subkeys( struct key *key )
+{
+    if (!(key->flags & KEY_UNSORTED)) return;
+    qsort( key->subkeys, key->last_subkey + 1, sizeof(*key->subkeys), subkey_compare );
+    key->flags &= ~KEY_UNSORTED;
 }
 
 /* save a registry and all its subkeys to a text file */
-static void save_subkeys( const struct key *key, const struct key *base, FILE *f )
+static void save_subkeys( struct key *key, const struct key *base, FILE *f )
 {
     int i;
 
     if (key->flags & KEY_VOLATILE) return;
+    sort_subkeys( key );
     /* save key if it has either some values or no subkeys, or needs special options */
     /* keys with no values but subkeys are saved implicitly by saving the subkeys */
     if ((key->last_value >= 0) || (key->last_subkey == -1) || key->class || (key->flags & KEY_SYMLINK))
@@ -424,6 +471,7 @@ static void key_destroy( struct object *obj )
         release_object( key->subkeys[i] );
     }
     free( key->subkeys );
+    free( key->subkey_hash );
     /* unconditionally notify everything waiting on this key */
     while ((ptr = list_head( &key->notify_list )))
     {
@@ -487,6 +535,8 @@ static struct key *alloc_key( const struct unicode_str *name, timeout_t modif )
         key->last_subkey = -1;
         key->nb_subkeys  = 0;
         key->subkeys     = NULL;
+        key->subkey_hash = NULL;
+        key->hash_size   = 0;
         key->nb_values   = 0;
         key->last_value  = -1;
         key->values      = NULL;
@@ -551,6 +601,45 @@ static void touch_key( struct key *key, unsigned int change )
         check_notify( k, change, 0 );
 }
 
+static unsigned int hash_subkey_name( const WCHAR *name, data_size_t len )
+{
+    unsigned int i, hash = 0;
+
+    for (i = 0; i < len / sizeof(WCHAR); i++) hash = hash * 65599 + tolowerW( name[i] );
+    return hash;
+}
+
+static void add_subkey_hash( struct key *parent, struct key *key )
+{
+    struct key **bucket = &parent->subkey_hash[hash_subkey_name( key->name, key->namelen ) & (parent->hash_size - 1)];
+
+    key->hash_next = *bucket;
+    *bucket = key;
+}
+
+static void remove_subkey_hash( struct key *parent, struct key *key )
+{
+    struct key **ptr = &parent->subkey_hash[hash_subkey_name( key->name, key->namelen ) & (parent->hash_size - 1)];
+
+    while (*ptr != key) ptr = &(*ptr)->hash_next;
+    *ptr = key->hash_next;
+}
+
+/* (re)build the subkeys hash table; the array is kept for enumeration */
+static void build_subkey_hash( struct key *key )
+{
+    struct key **hash;
+    unsigned int size = MIN_HASHED_SUBKEYS;
+    int i;
+
+    while (size < key->last_subkey + 1) size *= 2;
+    if (!(hash = calloc( size, sizeof(*hash) ))) return;  /* keep using the current lookup method */
+    free( key->subkey_hash );
+    key->subkey_hash = hash;
+    key->hash_size   = size;
+    for (i = 0; i <= key->last_subkey; i++) add_subkey_hash( key, key->subkeys[i] );
+}
+
 /* try to grow the array of subkeys; return 1 if OK, 0 on error */
 static int grow_subkeys( struct key *key )
 {
@@ -581,7 +670,6 @@ static struct key *alloc_subkey( struct key *parent, const struct unicode_str *n
                                  int index, timeout_t modif )
 {
     struct key *key;
-    int i;
 
     if (name->len > MAX_NAME_LEN * sizeof(WCHAR))
     {
@@ -596,9 +684,18 @@ static struct key *alloc_subkey( struct key *parent, const struct unicode_str *n
     if ((key = alloc_key( name, modif )) != NULL)
     {
         key->parent = parent;
-        for (i = ++parent->last_subkey; i > index; i--)
-            parent->subkeys[i] = parent->subkeys[i-1];
+        memmove( parent->subkeys + index + 1, parent->subkeys + index,
+                 (++parent->last_subkey - index) * sizeof(*parent->subkeys) );
         parent->subkeys[index] = key;
+        if (parent->subkey_hash)
+        {
+            /* new subkeys are appended, the array is sorted again when needed */
+            if (index && compare_subkey_name( parent->subkeys[index - 1], key->name, key->namelen ) > 0)
+                parent->flags |= KEY_UNSORTED;
+            add_subkey_hash( parent, key );
+            if (parent->last_subkey + 1 > 2 * parent->hash_size) build_subkey_hash( parent );
+        }
+        else if (parent->last_subkey + 1 >= MIN_HASHED_SUBKEYS) build_subkey_hash( parent );
         if (is_wow6432node( key->name, key->namelen ) && !is_wow6432node( parent->name, parent->namelen ))
             parent->flags |= KEY_WOW64;
     }
@@ -609,13 +706,15 @@ static struct key *alloc_subkey( struct key *parent, const struct unicode_str *n
 static void free_subkey( struct key *parent, int index )
 {
     struct key *key;
-    int i, nb_subkeys;
+    int nb_subkeys;
 
     assert( index >= 0 );
     assert( index <= parent->last_subkey );
 
     key = parent->subkeys[index];
-    for (i = index; i < parent->last_subkey; i++) parent->subkeys[i] = parent->subkeys[i + 1];
+    if (parent->subkey_hash) remove_subkey_hash( parent, key );
+    memmove( parent->subkeys + index, parent->subkeys + index + 1,
+             (parent->last_subkey - index) * sizeof(*parent->subkeys) );
     parent->last_subkey--;
     key->flags |= KEY_DELETED;
     key->parent = NULL;
@@ -635,20 +734,18 @@ static void free_subkey( struct key *parent, int index )
     }
 }
 
-/* find the named child of a given key and return its index */
-static struct key *find_subkey( const struct key *key, const struct unicode_str *name, int *index )
+/* find the named child of a given key in the sorted array and return its index */
+static struct key *search_subkey( const struct key *key, const struct unicode_str *name, int *index )
 {
     int i, min, max, res;
-    data_size_t len;
 
+    assert( !(key->flags & KEY_UNSORTED) );
     min = 0;
     max = key->last_subkey;
     while (min <= max)
     {
         i = (min + max) / 2;
-        len = min( key->subkeys[i]->namelen, name->len );
-        res = memicmpW( key->subkeys[i]->name, name->str, len / sizeof(WCHAR) );
-        if (!res) res = key->subkeys[i]->namelen - name->len;
+        res = compare_subkey_name( key->subkeys[i], name->str, name->len );
         if (!res)
         {
             *index = i;
@@ -661,6 +758,21 @@ static struct key *find_subkey( const struct key *key, const struct unicode_str
     return NULL;
 }
 
+/* find the named child of a given key and return the index where it should be inserted */
+static struct key *find_subkey( const struct key *key, const struct unicode_str *name, int *index )
+{
+    struct key *subkey;
+
+    if (!key->subkey_hash) return search_subkey( key, name, index );
+
+    /* the new subkey is appended, see alloc_subkey */
+    *index = key->last_subkey + 1;
+    for (subkey = key->subkey_hash[hash_subkey_name( name->str, name->len ) & (key->hash_size - 1)];
+         subkey; subkey = subkey->hash_next)
+        if (!compare_subkey_name( subkey, name->str, name->len )) return subkey;
+    return NULL;
+}
+
 /* return the wow64 variant of the key, or the key itself if none */
 static struct key *find_wow64_subkey( struct key *key, const struct unicode_str *name )
 {
@@ -877,7 +989,7 @@ static struct key *create_key_recursive( struct key *key, const struct unicode_s
 }
 
 /* query information about a key or a subkey */
-static void enum_key( const struct key *key, int index, int info_class,
+static void enum_key( struct key *key, int index, int info_class,
                       struct enum_key_reply *reply )
 {
     static const WCHAR backslash[] = { '\\' };
@@ -895,6 +1007,7 @@ static void enum_key( const struct key *key, int index, int info_class,
             set_error( STATUS_NO_MORE_ENTRIES );
             return;
         }
+        sort_subkeys( key );
         key = key->subkeys[index];
     }
 
@@ -986,7 +1099,8 @@ static void enum_key( const struct key *key, int index, int info_class,
 static int delete_key( struct key *key, int recurse )
 {
     int index;
-    struct key *parent = key->parent;
+    struct key *parent = key->parent, *found;
+    struct unicode_str name;
 
     /* must find parent and index */
     if (key == root_key)
@@ -1000,9 +1114,12 @@ static int delete_key( struct key *key, int recurse )
         if (0 > delete_key(key->subkeys[key->last_subkey], 1))
             return -1;
 
-    for (index = 0; index <= parent->last_subkey; index++)
-        if (parent->subkeys[index] == key) break;
-    assert( index <= parent->last_subkey );
+    /* subkey names are unique, so a lookup by name finds the key itself */
+    name.str = key->name;
+    name.len = key->namelen;
+    sort_subkeys( parent );
+    found = search_subkey( parent, &name, &index );
+    assert( found == key );
 
     /* we can only delete a key that has no subkeys */
     if (key->last_subkey >= 0)
@@ -1073,7 +1190,6 @@ static struct key_value *insert_value( struct key *key, const struct unicode_str
 {
     struct key_value *value;
     WCHAR *new_name = NULL;
-    int i;
 
     if (name->len > MAX_VALUE_LEN * sizeof(WCHAR))
     {
@@ -1085,7 +1201,8 @@ static struct key_value *insert_value( struct key *key, const struct unicode_str
         if (!grow_values( key )) return NULL;
     }
     if (name->len && !(new_name = memdup( name->str, name->len ))) return NULL;
-    for (i = ++key->last_value; i > index; i--) key->values[i] = key->values[i - 1];
+    memmove( key->values + index + 1, key->values + index,
+             (++key->last_value - index) * sizeof(*key->values) );
     value = &key->values[index];
     value->name    = new_name;
     value->namelen = name->len;
@@ -1217,7 +1334,7 @@ static void enum_value( struct key *key, int i, int info_class, struct enum_key_
 static void delete_value( struct key *key, const struct unicode_str *name )
 {
     struct key_value *value;
-    int i, index, nb_values;
+    int index, nb_values;
 
     if (!(value = find_value( key, name, &index )))
     {
@@ -1227,7 +1344,8 @@ static void delete_value( struct key *key, const struct unicode_str *name )
     if (debug_level > 1) dump_operation( key, value, "Delete" );
     free( value->name );
     free( value->data );
-    for (i = index; i < key->last_value; i++) key->values[i] = key->values[i + 1];
+    memmove( key->values + index, key->values + index + 1,
+             (key->last_value - index) * sizeof(*key->values) );
     key->last_value--;
     touch_key( key, REG_NOTIFY_CHANGE_LAST_SET );
 
@@ -1474,15 +1592,17 @@ static int parse_hex( unsigned char *dest, data_size_t *len, const char *buffer
 {
     const char *p = buffer;
     data_size_t count = 0;
-    char *end;
 
     while (isxdigit(*p))
     {
-        unsigned int val = strtoul( p, &end, 16 );
-        if (end == p || val > 0xff) return -1;
+        unsigned int val = 0;
+        do
+        {
+            val = (val << 4) | (*p <= '9' ? *p - '0' : (*p | 0x20) - 'a' + 10);
+            if (val > 0xff) return -1;
+        } while (isxdigit(*++p));
         if (count++ >= *len) return -1;  /* dest buffer overflow */
         *dest++ = val;
-        p = end;
         while (isspace(*p)) p++;
         if (*p == ',') p++;
         while (isspace(*p)) p++;
@@ -1707,6 +1827,7 @@ static void load_registry( struct key *key, obj_handle_t handle )
         FILE *f = fdopen( fd, "r" );
         if (f)
         {
+            setvbuf( f, NULL, _IOFBF, file_buffer_size );
             load_keys( key, NULL, f, -1 );
             fclose( f );
         }
@@ -1721,6 +1842,7 @@ static int load_init_registry_from_file( const char *filename, struct key *key )
 
     if ((f = fopen( filename, "r" )))
     {
+        setvbuf( f, NULL, _IOFBF, file_buffer_size );
         load_keys( key, filename, f, 0 );
         fclose( f );
         if (get_error() == STATUS_NOT_REGISTRY_FILE)
@@ -1913,6 +2035,7 @@ static void save_registry( struct key *key, obj_handle_t handle )
         FILE *f = fdopen( fd, "w" );
         if (f)
         {
+            setvbuf( f, NULL, _IOFBF, file_buffer_size );
             save_all_subkeys( key, f );
             if (fclose( f )) file_set_error();
         }
@@ -1982,6 +2105,7 @@ static int save_branch( struct key *key, const char *path )
         dump_operation( key, NULL, "saving" );
     }
 
+    setvbuf( f, NULL, _IOFBF, file_buffer_size );
     save_all_subkeys( key, f );
     ret = !fclose(f);
 
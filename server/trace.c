@@ -1203,6 +1203,25 @@ static void dump_varargs_rawinput_devices(const char *prefix, data_size_t size )
     fputc( '}', stderr );
 }
 
+static void dump_varargs_completion_entries( const char *prefix, data_size_t size )
+{
+    const struct completion_entry *entry;
+
+    fprintf( stderr, "%s{", prefix );
+    while (size >= sizeof(*entry))
+    {
+        entry = cur_data;
+        dump_uint64( "{ckey=", &entry->ckey );
+        dump_uint64( ",cvalue=", &entry->cvalue );
+        dump_uint64( ",information=", &entry->information );
+        fprintf( stderr, ",status=%s}", get_status_name( entry->status ) );
+        size -= sizeof(*entry);
+        remove_data( sizeof(*entry) );
+        if (size) fputc( ',', stderr );
+    }
+    fputc( '}', stderr );
+}
+
 static void dump_varargs_handle_infos( const char *prefix, data_size_t size )
 {
     const struct handle_info *handle;
@@ -2760,6 +2779,16 @@ static void dump_get_msg_queue_reply( const struct get_msg_queue_reply *req )
     fprintf( stderr, " handle=%04x", req->handle );
 }
 
+static void dump_get_msg_queue_status_section_request( const struct get_msg_queue_status_section_request *req )
+{
+}
+
+static void dump_get_msg_queue_status_section_reply( const struct get_msg_queue_status_section_reply *req )
+{
+    fprintf( stderr, " handle=%04x", req->handle );
+    dump_uint64( ", size=", &req->size );
+}
+
 static void dump_set_queue_fd_request( const struct set_queue_fd_request *req )
 {
     fprintf( stderr, " handle=%04x", req->handle );
@@ -3100,6 +3129,16 @@ static void dump_get_window_info_reply( const struct get_window_info_reply *req
     fprintf( stderr, ", awareness=%d", req->awareness );
 }
 
+static void dump_get_shared_window_section_request( const struct get_shared_window_section_request *req )
+{
+}
+
+static void dump_get_shared_window_section_reply( const struct get_shared_window_section_reply *req )
+{
+    fprintf( stderr, " handle=%04x", req->handle );
+    dump_uint64( ", size=", &req->size );
+}
+
 static void dump_set_window_info_request( const struct set_window_info_request *req )
 {
     fprintf( stderr, " flags=%04x", req->flags );
@@ -4364,6 +4403,16 @@ static void dump_remove_completion_reply( const struct remove_completion_reply *
     fprintf( stderr, ", status=%08x", req->status );
 }
 
+static void dump_remove_completions_request( const struct remove_completions_request *req )
+{
+    fprintf( stderr, " handle=%04x", req->handle );
+}
+
+static void dump_remove_completions_reply( const struct remove_completions_reply *req )
+{
+    dump_varargs_completion_entries( " entries=", cur_size );
+}
+
 static void dump_query_completion_request( const struct query_completion_request *req )
 {
     fprintf( stderr, " handle=%04x", req->handle );
@@ -4676,6 +4725,7 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_empty_atom_table_request,
     (dump_func)dump_init_atom_table_request,
     (dump_func)dump_get_msg_queue_request,
+    (dump_func)dump_get_msg_queue_status_section_request,
     (dump_func)dump_set_queue_fd_request,
     (dump_func)dump_set_queue_mask_request,
     (dump_func)dump_get_queue_status_request,
@@ -4706,6 +4756,7 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_get_desktop_window_request,
     (dump_func)dump_set_window_owner_request,
     (dump_func)dump_get_window_info_request,
+    (dump_func)dump_get_shared_window_section_request,
     (dump_func)dump_set_window_info_request,
     (dump_func)dump_set_parent_request,
     (dump_func)dump_get_window_parents_request,
@@ -4812,6 +4863,7 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_open_completion_request,
     (dump_func)dump_add_completion_request,
     (dump_func)dump_remove_completion_request,
+    (dump_func)dump_remove_completions_request,
     (dump_func)dump_query_completion_request,
     (dump_func)dump_set_completion_info_request,
     (dump_func)dump_add_fd_completion_request,
@@ -4970,6 +5022,7 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] = {
     NULL,
     (dump_func)dump_init_atom_table_reply,
     (dump_func)dump_get_msg_queue_reply,
+    (dump_func)dump_get_msg_queue_status_section_reply,
     NULL,
     (dump_func)dump_set_queue_mask_reply,
     (dump_func)dump_get_queue_status_reply,
@@ -5000,6 +5053,7 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_get_desktop_window_reply,
     (dump_func)dump_set_window_owner_reply,
     (dump_func)dump_get_window_info_reply,
+    (dump_func)dump_get_shared_window_section_reply,
     (dump_func)dump_set_window_info_reply,
     (dump_func)dump_set_parent_reply,
     (dump_func)dump_get_window_parents_reply,
@@ -5106,6 +5160,7 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_open_completion_reply,
     NULL,
     (dump_func)dump_remove_completion_reply,
+    (dump_func)dump_remove_completions_reply,
     (dump_func)dump_query_completion_reply,
     NULL,
     NULL,
@@ -5264,6 +5319,7 @@ static const char * const req_names[REQ_NB_REQUESTS] = {
     "empty_atom_table",
     "init_atom_table",
     "get_msg_queue",
+    "get_msg_queue_status_section",
     "set_queue_fd",
     "set_queue_mask",
     "get_queue_status",
@@ -5294,6 +5350,7 @@ static const char * const req_names[REQ_NB_REQUESTS] = {
     "get_desktop_window",
     "set_window_owner",
     "get_window_info",
+    "get_shared_window_section",
     "set_window_info",
     "set_parent",
     "get_window_parents",
@@ -5400,6 +5457,7 @@ static const char * const req_names[REQ_NB_REQUESTS] = {
     "open_completion",
     "add_completion",
     "remove_completion",
+    "remove_completions",
     "query_completion",
     "set_completion_info",
     "add_fd_completion",
@@ -33,6 +33,8 @@
 #include "winternl.h"
 
 #include "object.h"
+#include "file.h"
+#include "handle.h"
 #include "request.h"
 #include "thread.h"
 #include "process.h"
@@ -117,6 +119,11 @@ struct user_handle_array
 
 static const rectangle_t empty_rect;
 
+/* window information shared read-only with the clients, indexed by user handle */
+#define NB_SHARED_WINDOWS ((LAST_USER_HANDLE - FIRST_USER_HANDLE + 1) >> 1)
+static struct mapping *shared_window_mapping;
+static shared_window_t *shared_windows;
+
 /* global window pointers */
 static struct window *shell_window;
 static struct window *shell_listview;
@@ -137,6 +144,65 @@ static inline struct window *get_window( user_handle_t handle )
     return ret;
 }
 
+/* create the shared window section; it is created before the first window */
+/* so that all windows get published in it */
+static int init_shared_windows(void)
+{
+    static int init_done;
+
+    if (!init_done)
+    {
+        init_done = 1;
+        if ((shared_window_mapping = create_shared_mapping( NB_SHARED_WINDOWS * sizeof(*shared_windows),
+                                                            (void **)&shared_windows )))
+            make_object_static( (struct object *)shared_window_mapping );
+        clear_error();
+    }
+    return shared_windows != NULL;
+}
+
+/* retrieve the shared entry of a window */
+static shared_window_t *get_shared_window( user_handle_t handle )
+{
+    if (!init_shared_windows()) return NULL;
+    return &shared_windows[((handle & 0xffff) - FIRST_USER_HANDLE) >> 1];
+}
+
+/* publish the current state of a window in the shared section */
+static void update_shared_window( struct window *win )
+{
+    shared_window_t *entry = get_shared_window( win->handle );
+
+    if (!entry) return;
+
+    /* readers retry while the sequence counter is odd or has changed */
+    entry->seq++;
+    __sync_synchronize();
+    entry->handle   = win->handle;
+    entry->parent   = win->parent ? win->parent->handle : 0;
+    entry->owner    = win->owner;
+    entry->style    = win->style;
+    entry->ex_style = win->ex_style;
+    entry->pid      = win->thread ? get_process_id( win->thread->process ) : 0;
+    entry->tid      = win->thread ? get_thread_id( win->thread ) : 0;
+    __sync_synchronize();
+    entry->seq++;
+}
+
+/* remove a window from the shared section */
+static void remove_shared_window( struct window *win )
+{
+    shared_window_t *entry = get_shared_window( win->handle );
+
+    if (!entry) return;
+
+    entry->seq++;
+    __sync_synchronize();
+    entry->handle = 0;
+    __sync_synchronize();
+    entry->seq++;
+}
+
 /* check if window is the desktop */
 static inline int is_desktop_window( const struct window *win )
 {
@@ -240,6 +306,7 @@ static void link_window( struct window *win, struct window *previous )
     }
 
     win->is_linked = 1;
+    update_shared_window( win );
 }
 
 /* change the parent of a window (or unlink the window if the new parent is NULL) */
@@ -420,6 +487,7 @@ static void detach_window_thread( struct window *win )
     /* destroyed when the desktop ref count reaches zero */
     release_object( win->desktop );
     win->thread = NULL;
+    update_shared_window( win );
 }
 
 /* get the process owning the top window of a given desktop */
@@ -546,6 +614,7 @@ static struct window *create_window( struct window *parent, struct window *owner
     }
 
     current->desktop_users++;
+    update_shared_window( win );
     return win;
 
 failed:
@@ -1700,6 +1769,7 @@ static void set_window_pos( struct window *win, struct window *previous,
     if (!(swp_flags & SWP_NOZORDER) && win->parent) link_window( win, previous );
     if (swp_flags & SWP_SHOWWINDOW) win->style |= WS_VISIBLE;
     else if (swp_flags & SWP_HIDEWINDOW) win->style &= ~WS_VISIBLE;
+    update_shared_window( win );
 
     /* keep children at the same position relative to top right corner when the parent is mirrored */
     if (win->ex_style & WS_EX_LAYOUTRTL)
@@ -1899,6 +1969,7 @@ void destroy_window( struct window *win )
     if (win == taskman_window) taskman_window = NULL;
     free_hotkeys( win->desktop, win->handle );
     cleanup_clipboard_window( win->desktop, win->handle );
+    remove_shared_window( win );
     free_user_handle( win->handle );
     destroy_properties( win );
     list_remove( &win->entry );
@@ -2025,6 +2096,7 @@ DECL_HANDLER(get_desktop_window)
         {
             detach_window_thread( desktop->top_window );
             desktop->top_window->style  = WS_POPUP | WS_VISIBLE | WS_CLIPSIBLINGS | WS_CLIPCHILDREN;
+            update_shared_window( desktop->top_window );
         }
     }
 
@@ -2037,6 +2109,7 @@ DECL_HANDLER(get_desktop_window)
         {
             detach_window_thread( desktop->msg_window );
             desktop->msg_window->style = WS_POPUP | WS_CLIPSIBLINGS | WS_CLIPCHILDREN;
+            update_shared_window( desktop->msg_window );
         }
     }
 
@@ -2072,6 +2145,7 @@ DECL_HANDLER(set_window_owner)
 
     reply->prev_owner = win->owner;
     reply->full_owner = win->owner = owner ? owner->handle : 0;
+    update_shared_window( win );
 }
 
 
@@ -2146,6 +2220,21 @@ DECL_HANDLER(set_window_info)
 
     /* changing window style triggers a non-client paint */
     if (req->flags & SET_WIN_STYLE) win->paint_flags |= PAINT_NONCLIENT;
+    if (req->flags & (SET_WIN_STYLE | SET_WIN_EXSTYLE)) update_shared_window( win );
+}
+
+
+/* get a handle to the shared window section */
+DECL_HANDLER(get_shared_window_section)
+{
+    if (!init_shared_windows())
+    {
+        set_error( STATUS_NOT_SUPPORTED );
+        return;
+    }
+    reply->handle = alloc_handle( current->process, shared_window_mapping,
+                                  SECTION_QUERY | SECTION_MAP_READ, 0 );
+    reply->size   = NB_SHARED_WINDOWS * sizeof(*shared_windows);
 }
 
 